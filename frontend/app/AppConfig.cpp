@@ -23,6 +23,12 @@ AppConfig::AppConfig()
     , m_rememberLastDir(true)
     , m_allowScaleDefault(false)
     , m_minPointsRequired(3)
+    , m_useNativeSolver(true)
+    , m_prefetchRadius(2)
+    , m_imageCacheBudgetMB(1024)
+    , m_pyramidCacheBudgetMB(4096)
+    , m_undoLimit(500)
+    , m_undoMemoryBudgetMB(64)
     , m_settings(new QSettings("RigidLabeler", "Frontend"))
 {
 }
@@ -89,6 +95,16 @@ bool AppConfig::load(const QString &configPath)
         else if (currentSection == "transform") {
             if (key == "allow_scale_default") m_allowScaleDefault = (value == "true");
             else if (key == "min_points_required") m_minPointsRequired = value.toInt();
+            else if (key == "solver") m_useNativeSolver = (value != "backend");
+        }
+        else if (currentSection == "cache") {
+            if (key == "prefetch_radius") m_prefetchRadius = qMax(0, value.toInt());
+            else if (key == "memory_budget_mb") m_imageCacheBudgetMB = qMax<qint64>(0, value.toLongLong());
+            else if (key == "disk_budget_mb") m_pyramidCacheBudgetMB = qMax<qint64>(0, value.toLongLong());
+        }
+        else if (currentSection == "undo") {
+            if (key == "max_steps") m_undoLimit = qMax(0, value.toInt());
+            else if (key == "memory_budget_mb") m_undoMemoryBudgetMB = qMax<qint64>(0, value.toLongLong());
         }
     }
     
@@ -163,6 +179,7 @@ void AppConfig::setLastGTExportDir(const QString &dir)
 
 void AppConfig::saveProjectState(const QString &fixedImageDir,
                                   int fixedIndex, int movingIndex,
+                                  const QString &fixedFile, const QString &movingFile,
                                   const QString &movingImageDir,
                                   const QString &matrixExportDir,
                                   const QString &tiePointsExportDir)
@@ -179,6 +196,8 @@ void AppConfig::saveProjectState(const QString &fixedImageDir,
     m_settings->setValue("fixedImageDir", fixedImageDir);
     m_settings->setValue("fixedIndex", fixedIndex);
     m_settings->setValue("movingIndex", movingIndex);
+    m_settings->setValue("fixedFile", fixedFile);
+    m_settings->setValue("movingFile", movingFile);
     m_settings->setValue("movingImageDir", movingImageDir);
     m_settings->setValue("matrixExportDir", matrixExportDir);
     m_settings->setValue("tiePointsExportDir", tiePointsExportDir);
@@ -190,6 +209,7 @@ void AppConfig::saveProjectState(const QString &fixedImageDir,
 
 bool AppConfig::loadProjectState(const QString &fixedImageDir,
                                   int &fixedIndex, int &movingIndex,
+                                  QString &fixedFile, QString &movingFile,
                                   QString &movingImageDir,
                                   QString &matrixExportDir,
                                   QString &tiePointsExportDir)
@@ -210,6 +230,9 @@ bool AppConfig::loadProjectState(const QString &fixedImageDir,
     
     fixedIndex = m_settings->value("fixedIndex", 0).toInt();
     movingIndex = m_settings->value("movingIndex", 0).toInt();
+    // Absent in projects saved by older versions: the indices are used then
+    fixedFile = m_settings->value("fixedFile", "").toString();
+    movingFile = m_settings->value("movingFile", "").toString();
     movingImageDir = m_settings->value("movingImageDir", "").toString();
     matrixExportDir = m_settings->value("matrixExportDir", "").toString();
     tiePointsExportDir = m_settings->value("tiePointsExportDir", "").toString();
@@ -299,3 +322,33 @@ void AppConfig::setOptionLanguage(const QString &lang)
 {
     m_settings->setValue("options/language", lang);
 }
+
+bool AppConfig::optionShowLoupe() const
+{
+    return m_settings->value("options/showLoupe", false).toBool();
+}
+
+void AppConfig::setOptionShowLoupe(bool value)
+{
+    m_settings->setValue("options/showLoupe", value);
+}
+
+int AppConfig::optionLoupeZoom() const
+{
+    return m_settings->value("options/loupeZoom", 8).toInt();
+}
+
+void AppConfig::setOptionLoupeZoom(int zoom)
+{
+    m_settings->setValue("options/loupeZoom", zoom);
+}
+
+bool AppConfig::optionLoupeBicubic() const
+{
+    return m_settings->value("options/loupeBicubic", true).toBool();
+}
+
+void AppConfig::setOptionLoupeBicubic(bool value)
+{
+    m_settings->setValue("options/loupeBicubic", value);
+}
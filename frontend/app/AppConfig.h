@@ -33,6 +33,17 @@ public:
     // Transform settings
     bool allowScaleDefault() const { return m_allowScaleDefault; }
     int minPointsRequired() const { return m_minPointsRequired; }
+    // Estimate in-process instead of POSTing to /compute/rigid
+    bool useNativeSolver() const { return m_useNativeSolver; }
+
+    // Image cache settings
+    int prefetchRadius() const { return m_prefetchRadius; }
+    qint64 imageCacheBudgetBytes() const { return m_imageCacheBudgetMB * 1024 * 1024; }
+    qint64 pyramidCacheBudgetBytes() const { return m_pyramidCacheBudgetMB * 1024 * 1024; }
+
+    // Undo settings
+    int undoLimit() const { return m_undoLimit; }
+    qint64 undoMemoryBudgetBytes() const { return m_undoMemoryBudgetMB * 1024 * 1024; }
 
     // Persistent settings (saved between sessions)
     QString lastFixedImageDir() const;
@@ -48,11 +59,13 @@ public:
     // Saves and restores working state for each project
     void saveProjectState(const QString &fixedImageDir, 
                           int fixedIndex, int movingIndex,
+                          const QString &fixedFile, const QString &movingFile,
                           const QString &movingImageDir,
                           const QString &matrixExportDir,
                           const QString &tiePointsExportDir);
     bool loadProjectState(const QString &fixedImageDir,
                           int &fixedIndex, int &movingIndex,
+                          QString &fixedFile, QString &movingFile,
                           QString &movingImageDir,
                           QString &matrixExportDir,
                           QString &tiePointsExportDir);
@@ -74,6 +87,12 @@ public:
     void setOptionTransformMode(int mode);
     QString optionLanguage() const;
     void setOptionLanguage(const QString &lang);
+    bool optionShowLoupe() const;
+    void setOptionShowLoupe(bool value);
+    int optionLoupeZoom() const;
+    void setOptionLoupeZoom(int zoom);
+    bool optionLoupeBicubic() const;
+    void setOptionLoupeBicubic(bool value);
 
 private:
     AppConfig();
@@ -97,6 +116,16 @@ private:
     // Transform
     bool m_allowScaleDefault;
     int m_minPointsRequired;
+    bool m_useNativeSolver;
+
+    // Image cache
+    int m_prefetchRadius;
+    qint64 m_imageCacheBudgetMB;
+    qint64 m_pyramidCacheBudgetMB;
+
+    // Undo
+    int m_undoLimit;
+    qint64 m_undoMemoryBudgetMB;
 
     // Settings storage
     QSettings *m_settings;
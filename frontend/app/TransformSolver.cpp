@@ -0,0 +1,173 @@
+#include "TransformSolver.h"
+#include <QtMath>
+#include <cmath>
+
+namespace {
+
+// Affine normal equations closer to singular than this (relative) are rejected
+constexpr double CollinearTolerance = 1e-12;
+
+ComputeRigidResult failure(const QString &errorCode, const QString &message)
+{
+    ComputeRigidResult result;
+    result.errorCode = errorCode;
+    result.errorMessage = message;
+    return result;
+}
+
+} // namespace
+
+ComputeRigidResult TransformSolver::solve(const QVector<double> &packedPairs, Mode mode,
+                                          const QPointF &fixedOrigin, const QPointF &movingOrigin,
+                                          bool normalizedMatrix,
+                                          const QSize &fixedSize, const QSize &movingSize)
+{
+    const char *modeName = mode == Rigid ? "rigid" : mode == Similarity ? "similarity" : "affine";
+    const int count = int(packedPairs.size() / 4);
+    const int minPoints = mode == Affine ? 3 : 2;
+    if (count < minPoints) {
+        return failure("NOT_ENOUGH_POINTS",
+            QString("Not enough points to estimate %1 transform (got %2, need at least %3)")
+                .arg(modeName).arg(count).arg(minPoints));
+    }
+    if (normalizedMatrix && (fixedSize.isEmpty() || movingSize.isEmpty())) {
+        return failure("INVALID_INPUT",
+            QString("Image sizes are required for a normalized matrix"));
+    }
+
+    // Points relative to the origins: fixed (fx, fy), moving (mx, my)
+    const double *data = packedPairs.constData();
+    const double fox = fixedOrigin.x(), foy = fixedOrigin.y();
+    const double mox = movingOrigin.x(), moy = movingOrigin.y();
+
+    // Pass 1: centroids
+    double fixedX = 0, fixedY = 0, movingX = 0, movingY = 0;
+    for (int i = 0; i < count; ++i) {
+        const double *pair = data + 4 * i;
+        fixedX += pair[0] - fox;
+        fixedY += pair[1] - foy;
+        movingX += pair[2] - mox;
+        movingY += pair[3] - moy;
+    }
+    // NaN and Inf propagate into the sums
+    if (!std::isfinite(fixedX + fixedY + movingX + movingY)) {
+        return failure("INVALID_INPUT", QString("Input points contain NaN or Inf values"));
+    }
+    fixedX /= count;
+    fixedY /= count;
+    movingX /= count;
+    movingY /= count;
+
+    // Pass 2: centred moments of the moving points and cross-covariance H = X^T Y
+    double sxx = 0, sxy = 0, syy = 0;
+    double hxx = 0, hxy = 0, hyx = 0, hyy = 0;
+    for (int i = 0; i < count; ++i) {
+        const double *pair = data + 4 * i;
+        const double yx = pair[0] - fox - fixedX;
+        const double yy = pair[1] - foy - fixedY;
+        const double xx = pair[2] - mox - movingX;
+        const double xy = pair[3] - moy - movingY;
+        sxx += xx * xx;
+        sxy += xx * xy;
+        syy += xy * xy;
+        hxx += xx * yx;
+        hxy += xx * yy;
+        hyx += xy * yx;
+        hyy += xy * yy;
+    }
+
+    ComputeRigidResult result;
+    double a, b, c, d;  // Linear part [[a, b], [c, d]]
+    if (mode == Affine) {
+        // Least squares per output coordinate; both share the 2x2 normal matrix
+        const double det = sxx * syy - sxy * sxy;
+        if (!(det > CollinearTolerance * sxx * syy)) {
+            return failure("SINGULAR_TRANSFORM",
+                QString("Tie points are collinear; an affine transform needs 3 non-collinear points"));
+        }
+        a = (hxx * syy - sxy * hyx) / det;
+        b = (sxx * hyx - sxy * hxx) / det;
+        c = (hxy * syy - sxy * hyy) / det;
+        d = (sxx * hyy - sxy * hxy) / det;
+        decomposeAffine(a, b, c, d, result.rigid);
+    } else {
+        // 2D Procrustes: the best proper rotation maximises cos * (Hxx + Hyy) + sin * (Hxy - Hyx)
+        const double cosTerm = hxx + hyy;
+        const double sinTerm = hxy - hyx;
+        const double theta = std::atan2(sinTerm, cosTerm);
+        double scale = 1.0;
+        if (mode == Similarity) {
+            const double variance = sxx + syy;
+            if (variance < 1e-12) {
+                return failure("SINGULAR_TRANSFORM", QString("Source points have zero variance"));
+            }
+            scale = std::hypot(cosTerm, sinTerm) / variance;
+        }
+        a = scale * std::cos(theta);
+        b = -scale * std::sin(theta);
+        c = -b;
+        d = a;
+        result.rigid.theta_deg = qRadiansToDegrees(theta);
+        result.rigid.scale_x = scale;
+        result.rigid.scale_y = scale;
+        result.rigid.shear = 0.0;
+    }
+    const double tx = fixedX - (a * movingX + b * movingY);
+    const double ty = fixedY - (c * movingX + d * movingY);
+    result.rigid.tx = tx;
+    result.rigid.ty = ty;
+
+    // Pass 3: RMS of the residuals |T(moving) - fixed|
+    double sumSq = 0;
+    for (int i = 0; i < count; ++i) {
+        const double *pair = data + 4 * i;
+        const double mx = pair[2] - mox;
+        const double my = pair[3] - moy;
+        const double dx = a * mx + b * my + tx - (pair[0] - fox);
+        const double dy = c * mx + d * my + ty - (pair[1] - foy);
+        sumSq += dx * dx + dy * dy;
+    }
+    result.rmsError = std::sqrt(sumSq / count);
+    result.numPoints = count;
+
+    result.matrix3x3 = {{a, b, tx}, {c, d, ty}, {0.0, 0.0, 1.0}};
+    if (normalizedMatrix)
+        result.matrix3x3 = pixelMatrixToNormalized(result.matrix3x3, fixedSize, movingSize);
+    result.success = true;
+    return result;
+}
+
+QVector<QVector<double>> TransformSolver::pixelMatrixToNormalized(const QVector<QVector<double>> &matrix,
+                                                                  const QSize &fixedSize,
+                                                                  const QSize &movingSize)
+{
+    // M_norm = S_fixed^-1 * M * S_moving, S = diag(w / 2, h / 2, 1)
+    const double fixedScale[3] = {2.0 / fixedSize.width(), 2.0 / fixedSize.height(), 1.0};
+    const double movingScale[3] = {movingSize.width() / 2.0, movingSize.height() / 2.0, 1.0};
+    QVector<QVector<double>> normalized = matrix;
+    for (int i = 0; i < 3 && i < normalized.size(); ++i) {
+        for (int j = 0; j < 3 && j < normalized[i].size(); ++j)
+            normalized[i][j] *= fixedScale[i] * movingScale[j];
+    }
+    return normalized;
+}
+
+void TransformSolver::decomposeAffine(double a, double b, double c, double d, RigidParams &params)
+{
+    // A = Q * R with R = [[sx, shear * sy], [0, sy]]: Q's first column is A's
+    // first column over sx, and sy follows from |det A| = sx * sy
+    const double sx = std::hypot(a, c);
+    if (sx <= 0.0) {
+        const double sy = std::abs(d);
+        params.theta_deg = 0.0;
+        params.scale_x = 0.0;
+        params.scale_y = sy;
+        params.shear = sy > 1e-10 ? b / sy : 0.0;
+        return;
+    }
+    const double sy = std::abs(a * d - b * c) / sx;
+    params.theta_deg = qRadiansToDegrees(std::atan2(c, a));
+    params.scale_x = sx;
+    params.scale_y = sy;
+    params.shear = sy > 1e-10 ? (a * b + c * d) / sx / sy : 0.0;
+}
@@ -0,0 +1,59 @@
+#ifndef TRANSFORMSOLVER_H
+#define TRANSFORMSOLVER_H
+
+#include <QPointF>
+#include <QSize>
+#include <QVector>
+#include "BackendClient.h"
+
+/**
+ * @brief In-process estimation of the moving -> fixed transform from tie points.
+ *
+ * Computes the same estimates as the backend's /compute/rigid (transforms.py)
+ * without the HTTP round trip, so computing works with the backend down:
+ * - Rigid: rotation + translation (at least 2 points)
+ * - Similarity: rotation + translation + uniform scale (at least 2 points)
+ * - Affine: full 6-DOF least squares (at least 3 non-collinear points)
+ *
+ * Points are read straight from TiePointModel::packedCompletePairs(). Every
+ * estimate is a closed form over centred sums (the 2D Procrustes rotation is
+ * atan2 of the cross-covariance, the affine normal equations are a 2x2
+ * solve), so the cost is two passes over the points plus one for the RMS
+ * error: microseconds for thousands of points, with nothing allocated.
+ *
+ * Results use ComputeRigidResult, with the same parameters, matrix layout,
+ * affine decomposition (rotation * [[sx, shear * sy], [0, sy]]) and error
+ * codes as the backend response.
+ */
+class TransformSolver
+{
+public:
+    enum Mode {
+        Rigid,
+        Similarity,
+        Affine
+    };
+
+    // packedPairs: rows of (fixed x, fixed y, moving x, moving y) in pixels;
+    // fixedOrigin/movingOrigin are subtracted first (image centres for
+    // center-origin coordinates, zero for top-left). Parameters and RMS error
+    // are in those pixel coordinates. With normalizedMatrix, the matrix is
+    // converted to [-1, 1] coordinates of the given image sizes (center origin only).
+    static ComputeRigidResult solve(const QVector<double> &packedPairs, Mode mode,
+                                    const QPointF &fixedOrigin = QPointF(),
+                                    const QPointF &movingOrigin = QPointF(),
+                                    bool normalizedMatrix = false,
+                                    const QSize &fixedSize = QSize(),
+                                    const QSize &movingSize = QSize());
+
+    // Center-origin pixel matrix -> normalized [-1, 1] matrix (x / (w / 2), y / (h / 2))
+    static QVector<QVector<double>> pixelMatrixToNormalized(const QVector<QVector<double>> &matrix,
+                                                            const QSize &fixedSize,
+                                                            const QSize &movingSize);
+
+    // Rotation, scales and shear of the linear part [[a, b], [c, d]], as the
+    // backend's QR decomposition (sx, sy >= 0; a reflection stays in the matrix only)
+    static void decomposeAffine(double a, double b, double c, double d, RigidParams &params);
+};
+
+#endif // TRANSFORMSOLVER_H
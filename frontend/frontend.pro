@@ -1,4 +1,4 @@
-QT       += core gui network
+QT       += core gui network concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -14,16 +14,50 @@ SOURCES += \
     PreviewDialog.cpp \
     app/AppConfig.cpp \
     app/BackendClient.cpp \
+    app/TransformSolver.cpp \
+    model/DirectoryIndex.cpp \
+    model/ImageCache.cpp \
+    model/ImageHandle.cpp \
     model/ImagePairModel.cpp \
-    model/TiePointModel.cpp
+    model/PointGridIndex.cpp \
+    model/PyramidCache.cpp \
+    model/PyramidFile.cpp \
+    model/ThumbnailCache.cpp \
+    model/ThumbnailListModel.cpp \
+    model/TiePointModel.cpp \
+    model/TiePointProxyModel.cpp \
+    view/FilmstripDock.cpp \
+    view/ImageView.cpp \
+    view/LoupeWidget.cpp \
+    view/TiePointMarkerItem.cpp \
+    view/TiledImageItem.cpp \
+    view/WarpOverlayItem.cpp \
+    view/WindowLevel.cpp
 
 HEADERS += \
     mainwindow.h \
     PreviewDialog.h \
     app/AppConfig.h \
     app/BackendClient.h \
+    app/TransformSolver.h \
+    model/DirectoryIndex.h \
+    model/ImageCache.h \
+    model/ImageHandle.h \
     model/ImagePairModel.h \
-    model/TiePointModel.h
+    model/PointGridIndex.h \
+    model/PyramidCache.h \
+    model/PyramidFile.h \
+    model/ThumbnailCache.h \
+    model/ThumbnailListModel.h \
+    model/TiePointModel.h \
+    model/TiePointProxyModel.h \
+    view/FilmstripDock.h \
+    view/ImageView.h \
+    view/LoupeWidget.h \
+    view/TiePointMarkerItem.h \
+    view/TiledImageItem.h \
+    view/WarpOverlayItem.h \
+    view/WindowLevel.h
 
 FORMS += \
     mainwindow.ui
@@ -3,7 +3,6 @@
 #include <QApplication>
 #include <QProcess>
 #include <QDir>
-#include <QThread>
 
 static QProcess *g_backendProcess = nullptr;
 
@@ -16,9 +15,9 @@ void startBackend()
     if (QFile::exists(backendPath)) {
         g_backendProcess = new QProcess();
         g_backendProcess->setWorkingDirectory(appDir + "/backend/rigidlabeler_backend");
+        // Not waited for: MainWindow keeps polling the health endpoint until
+        // the backend answers, so the window shows right away
         g_backendProcess->start(backendPath);
-        // Wait a bit for backend to start
-        QThread::msleep(1500);
     }
     // If not exists, assume backend is running separately (development mode)
 }
@@ -1,9 +1,21 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "model/TiePointModel.h"
+#include "model/TiePointProxyModel.h"
 #include "model/ImagePairModel.h"
+#include "model/DirectoryIndex.h"
+#include "model/ImageCache.h"
+#include "model/PyramidCache.h"
+#include "model/ThumbnailCache.h"
+#include "view/TiledImageItem.h"
+#include "view/TiePointMarkerItem.h"
+#include "view/FilmstripDock.h"
+#include "view/ImageView.h"
+#include "view/LoupeWidget.h"
+#include "view/WarpOverlayItem.h"
 #include "app/BackendClient.h"
 #include "app/AppConfig.h"
+#include "app/TransformSolver.h"
 #include "PreviewDialog.h"
 
 #include <QFileDialog>
@@ -11,11 +23,11 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QGraphicsScene>
-#include <QGraphicsPixmapItem>
-#include <QGraphicsEllipseItem>
 #include <QGraphicsView>
 #include <QGraphicsItemGroup>
-#include <QGraphicsLineItem>
+#include <QHeaderView>
+#include <QDoubleSpinBox>
+#include <QStyleOptionGraphicsItem>
 #include <QWheelEvent>
 #include <QMouseEvent>
 #include <QKeyEvent>
@@ -26,21 +38,42 @@
 #include <QScrollBar>
 #include <QLineF>
 #include <QCoreApplication>
+#include <QApplication>
 #include <QGraphicsOpacityEffect>
 #include <QPropertyAnimation>
 #include <QLabel>
 #include <QTimer>
+#include <QSignalBlocker>
+#include <QProgressBar>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+#include <QtNumeric>
+#include <limits>
+#include <algorithm>
+#include <cmath>
 
 // ============================================================================
 // Undo Command Classes
 // ============================================================================
 
+// Base of the tie point commands: reports the memory it holds so the
+// history can be kept within the configured budget
+class TiePointCommand : public QUndoCommand
+{
+public:
+    using QUndoCommand::QUndoCommand;
+    
+    // Upper bound over the done and undone states
+    virtual qint64 byteSize() const { return sizeof(*this); }
+};
+
 // Undo command for adding a single point (fixed or moving)
-class AddPointCommand : public QUndoCommand
+class AddPointCommand : public TiePointCommand
 {
 public:
     AddPointCommand(TiePointModel *model, const QPointF &pos, bool isFixed, QUndoCommand *parent = nullptr)
-        : QUndoCommand(parent), m_model(model), m_position(pos), m_isFixed(isFixed), m_pairIndex(-1)
+        : TiePointCommand(parent), m_model(model), m_position(pos), m_isFixed(isFixed), m_pairIndex(-1)
     {
         setText(isFixed ? QObject::tr("Add Fixed Point") : QObject::tr("Add Moving Point"));
     }
@@ -76,37 +109,106 @@ private:
     int m_pairIndex;
 };
 
-// Undo command for removing a complete tie point pair (for delete button)
-class RemoveTiePointCommand : public QUndoCommand
+// Undo command for removing any number of pairs (delete, clear all).
+// Holds one compact snapshot instead of a command per row.
+class RemovePairsCommand : public TiePointCommand
 {
 public:
-    RemoveTiePointCommand(TiePointModel *model, int index, QUndoCommand *parent = nullptr)
-        : QUndoCommand(parent), m_model(model), m_index(index)
+    RemovePairsCommand(TiePointModel *model, const QVector<int> &pairIndices, const QString &text,
+                       QUndoCommand *parent = nullptr)
+        : TiePointCommand(parent), m_model(model), m_pairIndices(pairIndices)
     {
-        setText(QObject::tr("Delete Tie Point"));
-        // Store the tie point data before removal
-        TiePoint tp = m_model->getTiePoint(index);
-        m_fixed = tp.fixed;
-        m_moving = tp.moving;
-        // Store the pairIndex for proper restoration
-        m_pairIndex = m_model->getPairIndexAt(index);
+        setText(text);
     }
     
     void redo() override {
-        m_model->removeTiePoint(m_index);
+        m_batch = m_model->takePairs(m_pairIndices);
+        m_pairIndices.clear();  // The batch has them from now on
     }
     
     void undo() override {
-        // Restore with the original pairIndex
-        m_model->insertTiePoint(m_index, m_fixed, m_moving, m_pairIndex);
+        m_model->restorePairs(m_batch);
+        m_pairIndices = m_batch.pairIndices;
+    }
+    
+    qint64 byteSize() const override {
+        return sizeof(*this) + qMax<qint64>(m_pairIndices.size(), m_batch.size()) * TiePointBatch::BytesPerPair;
+    }
+    
+private:
+    TiePointModel *m_model;
+    QVector<int> m_pairIndices;
+    TiePointBatch m_batch;
+};
+
+// Undo command for a CSV import: the pairs are appended as the last rows,
+// so undo takes that tail off as one snapshot and redo puts it back
+class ImportPairsCommand : public TiePointCommand
+{
+public:
+    ImportPairsCommand(TiePointModel *model, const QList<TiePointPair> &pairs, QUndoCommand *parent = nullptr)
+        : TiePointCommand(parent), m_model(model), m_pairs(pairs), m_count(pairs.size())
+    {
+        setText(QObject::tr("Import %1 Tie Point(s)").arg(pairs.size()));
+    }
+    
+    void redo() override {
+        if (!m_pairs.isEmpty()) {
+            // First run: pair indices are assigned on append
+            const int first = m_model->rowCount();
+            m_count = m_model->appendPairs(m_pairs);
+            m_pairs.clear();
+            const TiePointSpan<int> pairIndices = m_model->pairIndices();
+            m_pairIndices = QVector<int>(pairIndices.begin() + first, pairIndices.end());
+        } else {
+            m_model->restorePairs(m_batch);
+            m_batch = TiePointBatch();
+        }
+    }
+    
+    void undo() override {
+        m_batch = m_model->takePairs(m_pairIndices);
+    }
+    
+    qint64 byteSize() const override {
+        return sizeof(*this) + qint64(m_count) * (TiePointBatch::BytesPerPair + sizeof(int));
+    }
+    
+private:
+    TiePointModel *m_model;
+    QList<TiePointPair> m_pairs;    // Until the first redo
+    int m_count;
+    QVector<int> m_pairIndices;
+    TiePointBatch m_batch;          // While undone
+};
+
+// Undo command for moving one point; pushed once per drag gesture, so each
+// drag is its own undo step
+class MovePointCommand : public TiePointCommand
+{
+public:
+    MovePointCommand(TiePointModel *model, int pairIndex, bool isFixed,
+                     const QPointF &from, const QPointF &to, QUndoCommand *parent = nullptr)
+        : TiePointCommand(parent), m_model(model), m_pairIndex(pairIndex), m_isFixed(isFixed)
+        , m_from(from), m_to(to)
+    {
+        setText(isFixed ? QObject::tr("Move Fixed Point") : QObject::tr("Move Moving Point"));
+    }
+    
+    void redo() override {
+        m_model->movePointDirect(m_pairIndex, m_isFixed, m_to);
+    }
+    
+    void undo() override {
+        m_model->movePointDirect(m_pairIndex, m_isFixed, m_from);
     }
     
 private:
     TiePointModel *m_model;
-    int m_index;
     int m_pairIndex;
-    QPointF m_fixed;
-    QPointF m_moving;
+    bool m_isFixed;
+    QPointF m_from;
+    QPointF m_to;
 };
 
 // ============================================================================
@@ -115,15 +217,24 @@ MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , m_tiePointModel(new TiePointModel(this))
+    , m_tiePointProxy(new TiePointProxyModel(m_tiePointModel, this))
     , m_imagePairModel(new ImagePairModel(this))
+    , m_imageCache(new ImageCache(this))
+    , m_pyramidCache(new PyramidCache(this))
+    , m_thumbnailCache(new ThumbnailCache(this))
+    , m_filmstripDock(nullptr)
+    , m_fixedDirIndex(new DirectoryIndex(this))
+    , m_movingDirIndex(new DirectoryIndex(this))
     , m_backendClient(nullptr)
     , m_fixedScene(new QGraphicsScene(this))
     , m_movingScene(new QGraphicsScene(this))
-    , m_fixedPixmapItem(nullptr)
-    , m_movingPixmapItem(nullptr)
+    , m_fixedImageItem(nullptr)
+    , m_movingImageItem(nullptr)
+    , m_fixedMarkerItem(nullptr)
+    , m_movingMarkerItem(nullptr)
+    , m_warpOverlay(nullptr)
+    , m_loupe(new LoupeWidget(this))
     , m_pendingPointMarker(nullptr)
-    , m_cursorMarker(nullptr)
-    , m_cursorMarkerScene(nullptr)
     , m_hasValidTransform(false)
     , m_isAddingPoint(false)
     , m_zoomFactor(1.0)
@@ -133,7 +244,17 @@ MainWindow::MainWindow(QWidget *parent)
     , m_isSelecting(false)
     , m_fixedRubberBand(nullptr)
     , m_movingRubberBand(nullptr)
+    , m_dragPending(false)
+    , m_isDraggingPoint(false)
+    , m_dragPairIndex(-1)
+    , m_dragIsFixed(false)
+    , m_dragOtherSumSq(0.0)
+    , m_dragOtherCount(0)
+    , m_hasResidualTransform(false)
     , m_undoStack(new QUndoStack(this))
+    , m_undoBytes(0)
+    , m_undoPushedBytes(0)
+    , m_undoPushedCount(0)
     , m_translator(new QTranslator(this))
     , m_currentLanguage("en")
     , m_realtimeComputeTimer(new QTimer(this))
@@ -144,7 +265,13 @@ MainWindow::MainWindow(QWidget *parent)
     , m_previewDialog(nullptr)
     , m_currentPreviewGridSize(8)
     , m_showPointLabels(true)  // Default: show point labels
+    , m_restoreStage(0)
+    , m_restoreAwaitingFixed(false)
+    , m_restoreAwaitingMoving(false)
+    , m_restoreProgress(nullptr)
+    , m_healthCheckRetries(10)
 {
+    m_startupTimer.start();
     ui->setupUi(this);
     
     // Setup transform mode combo box with tooltips
@@ -182,6 +309,15 @@ MainWindow::MainWindow(QWidget *parent)
     // Load configuration
     AppConfig::instance().load();
     
+    // Decoded image cache in front of the image pair model
+    m_imageCache->setMemoryBudget(AppConfig::instance().imageCacheBudgetBytes());
+    m_imagePairModel->setImageCache(m_imageCache);
+    m_pyramidCache->setDiskBudget(AppConfig::instance().pyramidCacheBudgetBytes());
+    m_imagePairModel->setPyramidCache(m_pyramidCache);
+    
+    // Undo history length (only settable while the stack is empty)
+    m_undoStack->setUndoLimit(AppConfig::instance().undoLimit());
+    
     // Create backend client
     m_backendClient = new BackendClient(AppConfig::instance().backendBaseUrl(), this);
     
@@ -189,8 +325,23 @@ MainWindow::MainWindow(QWidget *parent)
     setupImageViews();
     installEventFilters();
     
+    // Thumbnail filmstrip for both directories, toggled from the View menu
+    m_filmstripDock = new FilmstripDock(m_thumbnailCache, this);
+    addDockWidget(Qt::BottomDockWidgetArea, m_filmstripDock);
+    ui->menuView->addSeparator();
+    ui->menuView->addAction(m_filmstripDock->toggleViewAction());
+    
     // Setup tie point table model (MUST be before setupConnections for selectionModel to exist)
-    ui->tiePointsTable->setModel(m_tiePointModel);
+    // The table shows the model through a sort/filter proxy; rows have one
+    // fixed height, so the view never measures rows and scales to 100k+
+    ui->tiePointsTable->setModel(m_tiePointProxy);
+    QHeaderView *rowHeader = ui->tiePointsTable->verticalHeader();
+    rowHeader->setSectionResizeMode(QHeaderView::Fixed);
+    rowHeader->setDefaultSectionSize(ui->tiePointsTable->fontMetrics().height() + 6);
+    rowHeader->hide();
+    ui->tiePointsTable->setWordWrap(false);
+    ui->tiePointsTable->horizontalHeader()->setSortIndicator(TiePointModel::ColIndex, Qt::AscendingOrder);
+    ui->tiePointsTable->setSortingEnabled(true);
     
     // Apply Excel-style selection highlighting to the table
     ui->tiePointsTable->setStyleSheet(
@@ -208,6 +359,10 @@ MainWindow::MainWindow(QWidget *parent)
     ui->chkShowPointLabels->setChecked(AppConfig::instance().optionShowPointLabels());
     m_showPointLabels = AppConfig::instance().optionShowPointLabels();
     ui->chkSyncZoom->setChecked(AppConfig::instance().optionSyncZoom());
+    ui->actionShowLoupe->setChecked(AppConfig::instance().optionShowLoupe());
+    ui->actionLoupeBicubic->setChecked(AppConfig::instance().optionLoupeBicubic());
+    m_loupe->setZoom(AppConfig::instance().optionLoupeZoom());
+    m_loupe->setFilter(AppConfig::instance().optionLoupeBicubic() ? LoupeWidget::Bicubic : LoupeWidget::Bilinear);
     ui->cmbTransformMode->setCurrentIndex(AppConfig::instance().optionTransformMode());
     
     // Restore language setting
@@ -244,14 +399,24 @@ MainWindow::MainWindow(QWidget *parent)
     statusBar()->addPermanentWidget(m_pointCountLabel);
     statusBar()->addPermanentWidget(m_zoomLabel);
     
+    // Startup restore progress (hidden unless a project is being restored)
+    m_restoreProgress = new QProgressBar(this);
+    m_restoreProgress->setRange(0, 3);
+    m_restoreProgress->setMaximumWidth(120);
+    m_restoreProgress->setFormat("%v/%m");
+    m_restoreProgress->hide();
+    statusBar()->addPermanentWidget(m_restoreProgress);
+    
     // Initial state update
     updateActionStates();
+    syncContrastControls();
     
     // Check backend health
     m_backendClient->healthCheck();
     
-    // Restore last project (delayed to ensure UI is ready)
-    QTimer::singleShot(100, this, &MainWindow::restoreLastProject);
+    // Restore last project in stages once the window is up; only the
+    // bookkeeping runs on the GUI thread
+    QTimer::singleShot(0, this, &MainWindow::restoreLastProject);
 }
 
 MainWindow::~MainWindow()
@@ -299,6 +464,15 @@ void MainWindow::setupConnections()
     connect(ui->actionZoomOut, &QAction::triggered, this, &MainWindow::zoomOut);
     connect(ui->actionFitToWindow, &QAction::triggered, this, &MainWindow::zoomToFitAll);
     connect(ui->actionSyncViews, &QAction::toggled, this, &MainWindow::toggleLinkViews);
+    connect(ui->actionShowLoupe, &QAction::toggled, this, [this](bool checked) {
+        AppConfig::instance().setOptionShowLoupe(checked);
+        if (!checked)
+            m_loupe->hide();
+    });
+    connect(ui->actionLoupeBicubic, &QAction::toggled, this, [this](bool checked) {
+        m_loupe->setFilter(checked ? LoupeWidget::Bicubic : LoupeWidget::Bilinear);
+        AppConfig::instance().setOptionLoupeBicubic(checked);
+    });
     connect(ui->actionCompute, &QAction::triggered, this, &MainWindow::computeTransform);
     connect(ui->actionAbout, &QAction::triggered, this, &MainWindow::showAbout);
     connect(ui->actionUndo, &QAction::triggered, this, &MainWindow::undo);
@@ -367,7 +541,10 @@ void MainWindow::setupConnections()
     connect(ui->chkRealtimeCompute, &QCheckBox::toggled, this, &MainWindow::onRealtimeComputeToggled);
     connect(ui->chkShowPointLabels, &QCheckBox::toggled, this, [this](bool checked) {
         m_showPointLabels = checked;
-        updatePointDisplay();
+        if (m_fixedMarkerItem)
+            m_fixedMarkerItem->setShowLabels(checked);
+        if (m_movingMarkerItem)
+            m_movingMarkerItem->setShowLabels(checked);
         AppConfig::instance().setOptionShowPointLabels(checked);
     });
     connect(ui->chkSyncZoom, &QCheckBox::toggled, this, [this](bool checked) {
@@ -379,25 +556,81 @@ void MainWindow::setupConnections()
         AppConfig::instance().setOptionTransformMode(index);
     });
     
+    // Display (contrast) controls
+    connect(ui->cmbContrastTarget, QOverload<int>::of(&QComboBox::currentIndexChanged), 
+            this, &MainWindow::syncContrastControls);
+    connect(ui->sliderLevel, &QSlider::valueChanged, this, &MainWindow::onContrastControlsChanged);
+    connect(ui->sliderWindow, &QSlider::valueChanged, this, &MainWindow::onContrastControlsChanged);
+    connect(ui->spinGamma, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
+            this, &MainWindow::onContrastControlsChanged);
+    connect(ui->btnAutoContrast, &QPushButton::clicked, this, &MainWindow::autoContrast);
+    connect(ui->btnResetContrast, &QPushButton::clicked, this, &MainWindow::resetContrast);
+    
+    // Warp overlay controls
+    connect(ui->chkWarpOverlay, &QCheckBox::toggled, this, &MainWindow::updateWarpOverlay);
+    connect(ui->cmbOverlayMode, QOverload<int>::of(&QComboBox::currentIndexChanged), 
+            this, &MainWindow::updateWarpOverlay);
+    connect(ui->sliderOverlayOpacity, &QSlider::valueChanged, this, &MainWindow::updateWarpOverlay);
+    
     // Real-time compute timer
     connect(m_realtimeComputeTimer, &QTimer::timeout, this, &MainWindow::onRealtimeComputeTimeout);
     
     // Tie point model - pair completed signal for real-time compute
     connect(m_tiePointModel, &TiePointModel::pairCompleted, this, &MainWindow::onPairCompleted);
     
+    connect(m_tiePointModel, &TiePointModel::modelCleared, this, [this]() {
+        // Residuals belonged to the previous point set
+        m_hasResidualTransform = false;
+    });
+    // Rows inserted, removed or reset under a marker drag (Delete, Undo,
+    // Redo): the drag ends and the point goes back if it still exists
+    auto cancelPointDrag = [this]() {
+        if (m_dragPending)
+            finishPointDrag(true);
+    };
+    connect(m_tiePointModel, &QAbstractItemModel::rowsInserted, this, cancelPointDrag);
+    connect(m_tiePointModel, &QAbstractItemModel::rowsRemoved, this, cancelPointDrag);
+    connect(m_tiePointModel, &QAbstractItemModel::modelReset, this, cancelPointDrag);
+    
     // Tie point table selection
     connect(ui->tiePointsTable->selectionModel(), &QItemSelectionModel::selectionChanged,
             this, &MainWindow::onTiePointSelectionChanged);
+    // A proxy reset drops the selection without selectionChanged()
+    connect(m_tiePointProxy, &TiePointProxyModel::modelReset, this, [this]() {
+        if (m_fixedMarkerItem)
+            m_fixedMarkerItem->clearSelection();
+        if (m_movingMarkerItem)
+            m_movingMarkerItem->clearSelection();
+    });
+    connect(ui->spinMinResidual, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            this, [this](double value) { m_tiePointProxy->setMinResidual(float(value)); });
     
     // Tie point model changes
-    connect(m_tiePointModel, &TiePointModel::rowsInserted, this, &MainWindow::updateTiePointViews);
-    connect(m_tiePointModel, &TiePointModel::rowsRemoved, this, &MainWindow::updateTiePointViews);
-    connect(m_tiePointModel, &TiePointModel::dataChanged, this, &MainWindow::updateTiePointViews);
+    // (markers follow row by row; only a reset rebuilds them)
+    connect(m_tiePointModel, &TiePointModel::rowsInserted, this, &MainWindow::onTiePointRowsInserted);
+    connect(m_tiePointModel, &TiePointModel::rowsRemoved, this, &MainWindow::onTiePointRowsRemoved);
+    connect(m_tiePointModel, &TiePointModel::dataChanged, this, &MainWindow::onTiePointDataChanged);
     connect(m_tiePointModel, &TiePointModel::modelReset, this, &MainWindow::updateTiePointViews);
     
     // Image pair model changes
     connect(m_imagePairModel, &ImagePairModel::fixedImageChanged, this, &MainWindow::updateImageViews);
     connect(m_imagePairModel, &ImagePairModel::movingImageChanged, this, &MainWindow::updateImageViews);
+    connect(m_imagePairModel, &ImagePairModel::fixedImageChanged, this, &MainWindow::onFixedImageLoaded);
+    connect(m_imagePairModel, &ImagePairModel::movingImageChanged, this, &MainWindow::onMovingImageLoaded);
+    connect(m_imagePairModel, &ImagePairModel::fixedImageRefined, this, &MainWindow::onFixedImageRefined);
+    connect(m_imagePairModel, &ImagePairModel::movingImageRefined, this, &MainWindow::onMovingImageRefined);
+    connect(m_imagePairModel, &ImagePairModel::fixedImageLoadFailed, this, &MainWindow::onFixedImageLoadFailed);
+    connect(m_imagePairModel, &ImagePairModel::movingImageLoadFailed, this, &MainWindow::onMovingImageLoadFailed);
+    
+    // Filmstrip navigation
+    connect(m_filmstripDock, &FilmstripDock::fixedIndexActivated, this, &MainWindow::goToFixedImage);
+    connect(m_filmstripDock, &FilmstripDock::movingIndexActivated, this, &MainWindow::goToMovingImage);
+    
+    // Directory listings grow while they are scanned and follow changes on disk
+    connect(m_fixedDirIndex, &DirectoryIndex::filesChanged, this, &MainWindow::onFixedFilesIndexed);
+    connect(m_movingDirIndex, &DirectoryIndex::filesChanged, this, &MainWindow::onMovingFilesIndexed);
+    connect(m_fixedDirIndex, &DirectoryIndex::scanFinished, this, &MainWindow::continueProjectRestore);
+    connect(m_movingDirIndex, &DirectoryIndex::scanFinished, this, &MainWindow::continueProjectRestore);
     
     // Backend client responses
     connect(m_backendClient, &BackendClient::healthCheckCompleted, this, &MainWindow::onHealthCheckCompleted);
@@ -427,6 +660,11 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event)
     if (event->type() == QEvent::KeyPress) {
         QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
         if (keyEvent->key() == Qt::Key_Escape) {
+            // Cancel a marker drag: the point goes back
+            if (m_dragPending) {
+                finishPointDrag(true);
+                return true;
+            }
             // Cancel adding point mode
             if (m_isAddingPoint) {
                 m_isAddingPoint = false;
@@ -442,6 +680,15 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event)
     // Handle wheel events for zoom
     if (event->type() == QEvent::Wheel && view) {
         QWheelEvent *wheelEvent = static_cast<QWheelEvent*>(event);
+        // Alt+Wheel changes the loupe magnification instead
+        if (m_loupe->isVisible() && (wheelEvent->modifiers() & Qt::AltModifier)) {
+            // Some platforms turn Alt+Wheel into horizontal scrolling
+            const int delta = wheelEvent->angleDelta().y() != 0 ? wheelEvent->angleDelta().y()
+                                                                : wheelEvent->angleDelta().x();
+            m_loupe->stepZoom(delta > 0 ? 1 : -1);
+            AppConfig::instance().setOptionLoupeZoom(m_loupe->zoom());
+            return true;
+        }
         wheelEventOnView(view, wheelEvent);
         if (ui->chkSyncZoom->isChecked()) {
             QGraphicsView *otherView = isFixed ? ui->movingImageView : ui->fixedImageView;
@@ -488,7 +735,14 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event)
                 QPointF scenePos = view->mapToScene(mouseEvent->pos());
                 int pointIndex = findPointAtPosition(view, scenePos);
                 if (pointIndex >= 0) {
-                    ui->tiePointsTable->selectRow(pointIndex);
+                    // The marker's row may be sorted elsewhere or filtered out of the table
+                    const int tableRow = m_tiePointProxy->proxyRow(pointIndex);
+                    if (tableRow >= 0)
+                        ui->tiePointsTable->selectRow(tableRow);
+                    else
+                        ui->tiePointsTable->clearSelection();
+                    // Moving the cursor from here drags the marker
+                    beginPointDrag(view, pointIndex, isFixed, mouseEvent->pos());
                 } else {
                     // Click on empty area: clear selection
                     ui->tiePointsTable->clearSelection();
@@ -501,6 +755,7 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event)
     // Handle mouse move
     if (event->type() == QEvent::MouseMove && view) {
         QMouseEvent *mouseEvent = static_cast<QMouseEvent*>(event);
+        updateLoupe(view, mouseEvent->position());
         
         // Panning with Ctrl+drag
         if (m_isPanning) {
@@ -522,21 +777,27 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event)
             (*rubberBand)->setGeometry(QRect(m_rubberBandOrigin, mouseEvent->pos()).normalized());
             return true;
         }
+        // Marker drag
+        else if (m_dragPending && isFixed == m_dragIsFixed) {
+            updatePointDrag(view, mouseEvent->pos());
+            return true;
+        }
         // Update cursor marker when in adding point mode
         else if (m_isAddingPoint) {
             QPointF scenePos = view->mapToScene(mouseEvent->pos());
-            QGraphicsScene *targetScene = isFixed ? m_fixedScene : m_movingScene;
+            ImageView *targetView = isFixed ? ui->fixedImageView : ui->movingImageView;
             
             // Show cursor marker on the view the mouse is over
-            updateCursorMarker(targetScene, scenePos);
+            updateCursorMarker(targetView, scenePos);
         }
     }
     
-    // Handle mouse leave - hide cursor marker
+    // Handle mouse leave - hide cursor marker and loupe
     if (event->type() == QEvent::Leave && view) {
         if (m_isAddingPoint) {
             clearCursorMarker();
         }
+        m_loupe->hide();
     }
     
     // Handle mouse release
@@ -566,6 +827,11 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event)
                 }
                 return true;
             }
+            // End marker drag
+            else if (m_dragPending) {
+                finishPointDrag(false);
+                return true;
+            }
         }
     }
     
@@ -588,6 +854,12 @@ void MainWindow::wheelEventOnView(QGraphicsView *view, QWheelEvent *event)
 void MainWindow::keyPressEvent(QKeyEvent *event)
 {
     if (event->key() == Qt::Key_Escape) {
+        // Cancel a marker drag: the point goes back
+        if (m_dragPending) {
+            finishPointDrag(true);
+            event->accept();
+            return;
+        }
         // Cancel adding point mode
         if (m_isAddingPoint) {
             m_isAddingPoint = false;
@@ -631,29 +903,37 @@ void MainWindow::loadFixedImage()
     if (fileName.isEmpty())
         return;
     
+    // An explicit choice replaces whatever the startup restore would load
+    abortProjectRestore();
+    
     // Save current tie points before switching
     saveProjectState();
     
     // Clear current tie points and transform
-    m_tiePointModel->clearAll();
+    clearTiePoints();
     m_hasValidTransform = false;
     ui->txtResult->clear();
     
-    if (m_imagePairModel->loadFixedImage(fileName)) {
-        QFileInfo fi(fileName);
-        AppConfig::instance().setLastFixedImageDir(fi.absolutePath());
-        m_fixedImageDir = fi.absolutePath();
-        m_fixedImageFiles = getImageFilesInDir(m_fixedImageDir);
-        m_fixedImageIndex = m_fixedImageFiles.indexOf(fi.fileName());
-        // Update filename label
-        ui->lblFixedFileName->setText(tr("%1 (%2/%3)")
-            .arg(fi.fileName())
-            .arg(m_fixedImageIndex + 1)
-            .arg(m_fixedImageFiles.size()));
-        statusBar()->showMessage(tr("Fixed image loaded: %1").arg(fileName), 3000);
-    } else {
-        showError(tr("Error"), tr("Failed to load fixed image."));
-    }
+    QFileInfo fi(fileName);
+    AppConfig::instance().setLastFixedImageDir(fi.absolutePath());
+    m_fixedImageDir = fi.absolutePath();
+    m_fixedImageIndex = -1;
+    // Only this file is listed at first; the rest arrives via onFixedFilesIndexed
+    m_fixedDirIndex->setDirectory(m_fixedImageDir, fi.fileName());
+    m_fixedImageFiles = m_fixedDirIndex->files();
+    m_fixedImageIndex = m_fixedImageFiles.indexOf(fi.fileName());
+    m_filmstripDock->setFixedFiles(m_fixedImageDir, m_fixedImageFiles);
+    m_filmstripDock->setCurrentFixedIndex(m_fixedImageIndex);
+    // Update filename label
+    ui->lblFixedFileName->setText(tr("%1 (%2/%3)")
+        .arg(fi.fileName())
+        .arg(m_fixedImageIndex + 1)
+        .arg(m_fixedImageFiles.size()));
+    
+    // Decode in the background; the view updates via fixedImageChanged
+    m_imagePairModel->requestFixedImage(fileName);
+    prefetchNeighborImages();
+    statusBar()->showMessage(tr("Loading fixed image: %1...").arg(fileName));
     
     updateActionStates();
 }
@@ -671,45 +951,58 @@ void MainWindow::loadMovingImage()
     if (fileName.isEmpty())
         return;
     
+    // An explicit choice replaces whatever the startup restore would load
+    abortProjectRestore();
+    
     // Save current tie points before switching
     saveProjectState();
     
     // Clear current tie points and transform
-    m_tiePointModel->clearAll();
+    clearTiePoints();
     m_hasValidTransform = false;
     ui->txtResult->clear();
     
-    if (m_imagePairModel->loadMovingImage(fileName)) {
-        QFileInfo fi(fileName);
-        AppConfig::instance().setLastMovingImageDir(fi.absolutePath());
-        m_movingImageDir = fi.absolutePath();
-        m_movingImageFiles = getImageFilesInDir(m_movingImageDir);
-        m_movingImageIndex = m_movingImageFiles.indexOf(fi.fileName());
-        // Update filename label
-        ui->lblMovingFileName->setText(tr("%1 (%2/%3)")
-            .arg(fi.fileName())
-            .arg(m_movingImageIndex + 1)
-            .arg(m_movingImageFiles.size()));
-        statusBar()->showMessage(tr("Moving image loaded: %1").arg(fileName), 3000);
-    } else {
-        showError(tr("Error"), tr("Failed to load moving image."));
-    }
+    QFileInfo fi(fileName);
+    AppConfig::instance().setLastMovingImageDir(fi.absolutePath());
+    m_movingImageDir = fi.absolutePath();
+    m_movingImageIndex = -1;
+    // Only this file is listed at first; the rest arrives via onMovingFilesIndexed
+    m_movingDirIndex->setDirectory(m_movingImageDir, fi.fileName());
+    m_movingImageFiles = m_movingDirIndex->files();
+    m_movingImageIndex = m_movingImageFiles.indexOf(fi.fileName());
+    m_filmstripDock->setMovingFiles(m_movingImageDir, m_movingImageFiles);
+    m_filmstripDock->setCurrentMovingIndex(m_movingImageIndex);
+    // Update filename label
+    ui->lblMovingFileName->setText(tr("%1 (%2/%3)")
+        .arg(fi.fileName())
+        .arg(m_movingImageIndex + 1)
+        .arg(m_movingImageFiles.size()));
+    
+    // Decode in the background; the view updates via movingImageChanged
+    m_imagePairModel->requestMovingImage(fileName);
+    prefetchNeighborImages();
+    statusBar()->showMessage(tr("Loading moving image: %1...").arg(fileName));
     
     updateActionStates();
 }
 
 void MainWindow::clearImages()
 {
+    abortProjectRestore();
     m_imagePairModel->clearImages();
-    m_tiePointModel->clearAll();
+    clearTiePoints();
     clearPendingPointMarker();
     clearCursorMarker();
+    m_loupe->hide();
+    m_loupe->setSource(nullptr);
     m_fixedScene->clear();
     m_movingScene->clear();
-    m_fixedPixmapItem = nullptr;
-    m_movingPixmapItem = nullptr;
-    m_fixedPointMarkers.clear();
-    m_movingPointMarkers.clear();
+    m_fixedImageItem = nullptr;
+    m_movingImageItem = nullptr;
+    syncContrastControls();
+    m_fixedMarkerItem = nullptr;
+    m_movingMarkerItem = nullptr;
+    m_warpOverlay = nullptr;
     ui->txtResult->clear();
     m_hasValidTransform = false;
     m_isAddingPoint = false;
@@ -734,9 +1027,10 @@ void MainWindow::saveLabel()
     
     // Collect tie points
     QList<QPair<QPointF, QPointF>> tiePoints;
-    for (const TiePoint &tp : m_tiePointModel->getAllTiePoints()) {
-        tiePoints.append({tp.fixed, tp.moving});
-    }
+    tiePoints.reserve(m_tiePointModel->completePairCount());
+    m_tiePointModel->forEachCompletePair([&tiePoints](int, const QPointF &fixed, const QPointF &moving) {
+        tiePoints.append({fixed, moving});
+    });
     
     RigidParams rigid;
     rigid.theta_deg = m_currentTheta;
@@ -793,38 +1087,57 @@ void MainWindow::computeTransform()
     double movingCenterX = 0, movingCenterY = 0;
     
     if (!m_useTopLeftOrigin) {
-        if (m_fixedPixmapItem) {
-            QPixmap pm = m_fixedPixmapItem->pixmap();
-            fixedCenterX = pm.width() / 2.0;
-            fixedCenterY = pm.height() / 2.0;
+        if (m_imagePairModel->hasFixedImage()) {
+            const QSize size = m_imagePairModel->fixedImageSize();
+            fixedCenterX = size.width() / 2.0;
+            fixedCenterY = size.height() / 2.0;
         }
-        if (m_movingPixmapItem) {
-            QPixmap pm = m_movingPixmapItem->pixmap();
-            movingCenterX = pm.width() / 2.0;
-            movingCenterY = pm.height() / 2.0;
+        if (m_imagePairModel->hasMovingImage()) {
+            const QSize size = m_imagePairModel->movingImageSize();
+            movingCenterX = size.width() / 2.0;
+            movingCenterY = size.height() / 2.0;
         }
     }
     
+    // Get image sizes for normalized matrix
+    QSize fixedSize, movingSize;
+    if (m_imagePairModel->hasFixedImage()) {
+        fixedSize = m_imagePairModel->fixedImageSize();
+    }
+    if (m_imagePairModel->hasMovingImage()) {
+        movingSize = m_imagePairModel->movingImageSize();
+    }
+    
+    // Use normalized matrix only when center origin is used
+    bool useNormalized = m_useNormalizedMatrix && !m_useTopLeftOrigin;
+    
+    // Complete tie points only, as (fixed x, fixed y, moving x, moving y) in pixels
+    const QVector<double> &packed = m_tiePointModel->packedCompletePairs();
+    int modeIndex = ui->cmbTransformMode->currentIndex();
+    
+    if (AppConfig::instance().useNativeSolver()) {
+        // Solved in-process straight from the packed pairs; no request, works offline
+        TransformSolver::Mode mode = modeIndex == 0 ? TransformSolver::Rigid
+                                   : modeIndex == 1 ? TransformSolver::Similarity
+                                   : TransformSolver::Affine;
+        onComputeRigidCompleted(TransformSolver::solve(packed, mode,
+                                                       QPointF(fixedCenterX, fixedCenterY),
+                                                       QPointF(movingCenterX, movingCenterY),
+                                                       useNormalized, fixedSize, movingSize));
+        return;
+    }
+    
     // Collect complete tie points only, converting to appropriate coordinate system
+    // (center offsets are zero in top-left mode)
     QList<QPair<QPointF, QPointF>> tiePoints;
-    for (const TiePoint &tp : m_tiePointModel->getAllTiePoints()) {
-        QPointF fixed = tp.fixed;
-        QPointF moving = tp.moving;
-        
-        // Convert to center-origin coordinates if needed
-        if (!m_useTopLeftOrigin) {
-            fixed.setX(fixed.x() - fixedCenterX);
-            fixed.setY(fixed.y() - fixedCenterY);
-            moving.setX(moving.x() - movingCenterX);
-            moving.setY(moving.y() - movingCenterY);
-        }
-        
-        tiePoints.append({fixed, moving});
+    tiePoints.reserve(packed.size() / 4);
+    for (qsizetype i = 0; i + 3 < packed.size(); i += 4) {
+        tiePoints.append({QPointF(packed[i] - fixedCenterX, packed[i + 1] - fixedCenterY),
+                          QPointF(packed[i + 2] - movingCenterX, packed[i + 3] - movingCenterY)});
     }
     
     // Get transform mode from combo box
     QString transformMode;
-    int modeIndex = ui->cmbTransformMode->currentIndex();
     switch (modeIndex) {
         case 0: transformMode = "rigid"; break;
         case 1: transformMode = "similarity"; break;
@@ -832,20 +1145,6 @@ void MainWindow::computeTransform()
         default: transformMode = "affine"; break;
     }
     
-    // Get image sizes for normalized matrix
-    QSize fixedSize, movingSize;
-    if (m_fixedPixmapItem) {
-        QPixmap pm = m_fixedPixmapItem->pixmap();
-        fixedSize = pm.size();
-    }
-    if (m_movingPixmapItem) {
-        QPixmap pm = m_movingPixmapItem->pixmap();
-        movingSize = pm.size();
-    }
-    
-    // Use normalized matrix only when center origin is used
-    bool useNormalized = m_useNormalizedMatrix && !m_useTopLeftOrigin;
-    
     m_backendClient->computeRigid(
         tiePoints,
         transformMode,
@@ -934,15 +1233,15 @@ void MainWindow::zoomOut()
 
 void MainWindow::zoomToFitFixed()
 {
-    if (m_fixedPixmapItem) {
-        ui->fixedImageView->fitInView(m_fixedPixmapItem, Qt::KeepAspectRatio);
+    if (m_fixedImageItem) {
+        ui->fixedImageView->fitInView(m_fixedImageItem, Qt::KeepAspectRatio);
     }
 }
 
 void MainWindow::zoomToFitMoving()
 {
-    if (m_movingPixmapItem) {
-        ui->movingImageView->fitInView(m_movingPixmapItem, Qt::KeepAspectRatio);
+    if (m_movingImageItem) {
+        ui->movingImageView->fitInView(m_movingImageItem, Qt::KeepAspectRatio);
     }
 }
 
@@ -957,6 +1256,144 @@ void MainWindow::toggleLinkViews(bool linked)
     ui->chkSyncZoom->setChecked(linked);
 }
 
+// ============================================================================
+// Display (Contrast) Controls
+// ============================================================================
+
+// Sliders span the data range for high-bit-depth images and the full code
+// range otherwise, so that 8-bit images can get back to an unmapped display
+static WindowLevel contrastSliderRange(const TiledImageItem *item)
+{
+    return item->isHighBitDepth() ? item->dataRange() : WindowLevel();
+}
+
+TiledImageItem* MainWindow::contrastTargetItem() const
+{
+    TiledImageItem *item = ui->cmbContrastTarget->currentIndex() == 0 ? m_fixedImageItem : m_movingImageItem;
+    return (item && !item->isNull()) ? item : nullptr;
+}
+
+void MainWindow::syncContrastControls()
+{
+    TiledImageItem *item = contrastTargetItem();
+    ui->sliderLevel->setEnabled(item != nullptr);
+    ui->sliderWindow->setEnabled(item != nullptr);
+    ui->spinGamma->setEnabled(item != nullptr);
+    ui->btnAutoContrast->setEnabled(item != nullptr);
+    ui->btnResetContrast->setEnabled(item != nullptr);
+    if (!item)
+        return;
+    
+    const WindowLevel range = contrastSliderRange(item);
+    const WindowLevel wl = item->windowLevel();
+    const double span = qMax(range.high - range.low, 1e-12);
+    
+    // Reflect the item's state without feeding it back
+    QSignalBlocker blockLevel(ui->sliderLevel);
+    QSignalBlocker blockWindow(ui->sliderWindow);
+    QSignalBlocker blockGamma(ui->spinGamma);
+    ui->sliderLevel->setValue(qRound(((wl.low + wl.high) / 2.0 - range.low) / span * 1000.0));
+    ui->sliderWindow->setValue(qRound((wl.high - wl.low) / span * 1000.0));
+    ui->spinGamma->setValue(wl.gamma);
+}
+
+void MainWindow::onContrastControlsChanged()
+{
+    TiledImageItem *item = contrastTargetItem();
+    if (!item)
+        return;
+    
+    const WindowLevel range = contrastSliderRange(item);
+    const double span = range.high - range.low;
+    const double center = range.low + span * ui->sliderLevel->value() / 1000.0;
+    const double width = span * ui->sliderWindow->value() / 1000.0;
+    
+    WindowLevel wl;
+    wl.low = center - width / 2.0;
+    wl.high = center + width / 2.0;
+    wl.gamma = ui->spinGamma->value();
+    
+    // Only the visible tiles are re-mapped; nothing is decoded again
+    item->setWindowLevel(wl);
+    updateWarpOverlay();
+}
+
+void MainWindow::autoContrast()
+{
+    TiledImageItem *item = contrastTargetItem();
+    if (!item)
+        return;
+    
+    WindowLevel wl = WindowLevel::fromPercentiles(item->handle().image(), 0.005, 0.995);
+    wl.gamma = ui->spinGamma->value();
+    item->setWindowLevel(wl);
+    syncContrastControls();
+    updateWarpOverlay();
+}
+
+void MainWindow::resetContrast()
+{
+    TiledImageItem *item = contrastTargetItem();
+    if (!item)
+        return;
+    
+    item->setWindowLevel(contrastSliderRange(item));
+    syncContrastControls();
+    updateWarpOverlay();
+}
+
+QTransform MainWindow::movingToFixedTransform() const
+{
+    const QVector<QVector<double>> &m = m_currentMatrix;
+    if (m.size() < 3 || m[0].size() < 3 || m[1].size() < 3 || m[2].size() < 3)
+        return QTransform();
+    
+    // p_fixed = M * p_moving (column vectors); QTransform maps row vectors
+    const QTransform matrix(m[0][0], m[1][0], m[2][0],
+                            m[0][1], m[1][1], m[2][1],
+                            m[0][2], m[1][2], m[2][2]);
+    if (m_useTopLeftOrigin)
+        return matrix;
+    
+    // The matrix works in center-origin pixels, or in [-1, 1] when normalized
+    const QSizeF fixedHalf = QSizeF(m_imagePairModel->fixedImageSize()) / 2.0;
+    const QSizeF movingHalf = QSizeF(m_imagePairModel->movingImageSize()) / 2.0;
+    QTransform toMatrix = QTransform::fromTranslate(-movingHalf.width(), -movingHalf.height());
+    QTransform fromMatrix;
+    if (m_useNormalizedMatrix) {
+        toMatrix *= QTransform::fromScale(1.0 / movingHalf.width(), 1.0 / movingHalf.height());
+        fromMatrix = QTransform::fromScale(fixedHalf.width(), fixedHalf.height());
+    }
+    fromMatrix *= QTransform::fromTranslate(fixedHalf.width(), fixedHalf.height());
+    return toMatrix * matrix * fromMatrix;
+}
+
+void MainWindow::updateWarpOverlay()
+{
+    const bool enabled = ui->chkWarpOverlay->isChecked();
+    ui->cmbOverlayMode->setEnabled(enabled);
+    ui->sliderOverlayOpacity->setEnabled(enabled);
+    
+    if (!enabled || !m_hasValidTransform || !m_fixedImageItem || !m_movingImageItem) {
+        if (m_warpOverlay)
+            m_warpOverlay->hide();
+        return;
+    }
+    
+    // Between the fixed image and the tie point markers
+    if (!m_warpOverlay) {
+        m_warpOverlay = new WarpOverlayItem();
+        m_warpOverlay->setZValue(0.5);
+        m_fixedScene->addItem(m_warpOverlay);
+    }
+    m_warpOverlay->setSource(m_movingImageItem);
+    m_warpOverlay->setWarp(m_currentPixelTransform);
+    m_warpOverlay->setMode(ui->cmbOverlayMode->currentIndex() == 1 ? WarpOverlayItem::Difference
+                                                                   : WarpOverlayItem::Blend);
+    m_warpOverlay->setOpacity(ui->sliderOverlayOpacity->value() / 100.0);
+    m_warpOverlay->show();
+}
+
 // ============================================================================
 // Tie Point Operations
 // ============================================================================
@@ -971,24 +1408,22 @@ void MainWindow::addTiePoint()
 
 void MainWindow::deleteSelectedTiePoint()
 {
-    QModelIndexList selected = ui->tiePointsTable->selectionModel()->selectedRows();
-    if (selected.isEmpty()) {
+    const QVector<int> rows = selectedModelRows();
+    if (rows.isEmpty()) {
         statusBar()->showMessage(tr("No tie point selected."), 2000);
         return;
     }
     
-    // Remove in reverse order to keep indices valid (use undo commands)
-    QList<int> rows;
-    for (const QModelIndex &index : selected) {
-        rows.append(index.row());
-    }
-    std::sort(rows.begin(), rows.end(), std::greater<int>());
-    
-    m_undoStack->beginMacro(tr("Delete %1 tie point(s)").arg(rows.size()));
+    // One undo step with a compact snapshot, however many rows
+    const TiePointSpan<int> allPairIndices = m_tiePointModel->pairIndices();
+    QVector<int> pairIndices;
+    pairIndices.reserve(rows.size());
     for (int row : rows) {
-        m_undoStack->push(new RemoveTiePointCommand(m_tiePointModel, row));
+        pairIndices.append(allPairIndices[row]);
     }
-    m_undoStack->endMacro();
+    
+    pushUndoCommand(new RemovePairsCommand(m_tiePointModel, pairIndices,
+                                           tr("Delete %1 tie point(s)").arg(pairIndices.size())));
     
     m_hasValidTransform = false;
     updateActionStates();
@@ -1006,20 +1441,52 @@ void MainWindow::clearAllTiePoints()
         QMessageBox::Yes | QMessageBox::No);
     
     if (ret == QMessageBox::Yes) {
-        m_undoStack->clear();  // Clear undo history since this is a reset
-        m_tiePointModel->clearAll();
+        // Undoable: all pairs go into one snapshot
+        const TiePointSpan<int> pairIndices = m_tiePointModel->pairIndices();
+        pushUndoCommand(new RemovePairsCommand(m_tiePointModel,
+                                               QVector<int>(pairIndices.begin(), pairIndices.end()),
+                                               tr("Clear All Tie Points")));
         m_hasValidTransform = false;
         ui->txtResult->clear();
-        updatePointDisplay();
         updateActionStates();
         statusBar()->showMessage(tr("All tie points cleared."), 2000);
     }
 }
 
-void MainWindow::onTiePointSelectionChanged()
+void MainWindow::onTiePointSelectionChanged(const QItemSelection &selected, const QItemSelection &deselected)
 {
-    // Redraw all points with proper highlighting
-    updatePointDisplay();
+    if (!m_fixedMarkerItem || !m_movingMarkerItem)
+        return;
+    
+    // Re-highlight only the rows whose selection changed, range by range
+    // (selection is row-wise, so a range's rows are wholly in or out)
+    for (const auto &change : {qMakePair(deselected, false), qMakePair(selected, true)}) {
+        QVector<int> rows;
+        for (const QItemSelectionRange &range : change.first) {
+            if (!range.isValid())
+                continue;
+            for (int row = range.top(); row <= range.bottom(); ++row)
+                rows.append(m_tiePointProxy->sourceRow(row));
+        }
+        m_fixedMarkerItem->setSelected(rows, change.second);
+        m_movingMarkerItem->setSelected(rows, change.second);
+    }
+}
+
+QVector<int> MainWindow::selectedModelRows() const
+{
+    // Walk the selection ranges instead of one index per selected cell
+    QVector<int> rows;
+    const QItemSelection selection = ui->tiePointsTable->selectionModel()->selection();
+    for (const QItemSelectionRange &range : selection) {
+        if (!range.isValid())
+            continue;
+        for (int row = range.top(); row <= range.bottom(); ++row)
+            rows.append(m_tiePointProxy->sourceRow(row));
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    return rows;
 }
 
 void MainWindow::onFixedViewClicked(const QPointF &pos)
@@ -1029,15 +1496,13 @@ void MainWindow::onFixedViewClicked(const QPointF &pos)
     
     // Create and execute AddPointCommand via QUndoStack
     AddPointCommand *cmd = new AddPointCommand(m_tiePointModel, pos, true);
-    m_undoStack->push(cmd);  // This calls cmd->redo() automatically
+    pushUndoCommand(cmd);  // This calls cmd->redo() automatically
     int index = cmd->pairIndex();
     
     // Display coordinates in current coordinate system
     ui->lblFixedCoord->setText(formatDisplayCoord(pos, true));
     QPointF displayPos = pixelToDisplayCoord(pos, true);
     
-    // Update display
-    updatePointDisplay();
     updateActionStates();
     
     // Check if this completes a pair
@@ -1058,15 +1523,13 @@ void MainWindow::onMovingViewClicked(const QPointF &pos)
     
     // Create and execute AddPointCommand via QUndoStack
     AddPointCommand *cmd = new AddPointCommand(m_tiePointModel, pos, false);
-    m_undoStack->push(cmd);  // This calls cmd->redo() automatically
+    pushUndoCommand(cmd);  // This calls cmd->redo() automatically
     int index = cmd->pairIndex();
     
     // Display coordinates in current coordinate system
     ui->lblMovingCoord->setText(formatDisplayCoord(pos, false));
     QPointF displayPos = pixelToDisplayCoord(pos, false);
     
-    // Update display
-    updatePointDisplay();
     updateActionStates();
     
     // Check if this completes a pair
@@ -1087,6 +1550,15 @@ void MainWindow::onMovingViewClicked(const QPointF &pos)
 
 void MainWindow::onHealthCheckCompleted(const HealthCheckResult &result)
 {
+    // The backend is launched alongside the frontend and may still be
+    // starting; keep polling for a few seconds before reporting it offline
+    if (!result.success && m_healthCheckRetries > 0) {
+        --m_healthCheckRetries;
+        QTimer::singleShot(500, m_backendClient, &BackendClient::healthCheck);
+        return;
+    }
+    m_healthCheckRetries = 0;
+    
     if (result.success) {
         m_backendStatusLabel->setText(tr("Backend: Online (v%1)").arg(result.version));
         m_backendStatusLabel->setStyleSheet("color: green;");
@@ -1112,6 +1584,16 @@ void MainWindow::onComputeRigidCompleted(const ComputeRigidResult &result)
     m_currentScaleY = result.rigid.scale_y;
     m_currentShear = result.rigid.shear;
     m_currentMatrix = result.matrix3x3;
+    // Later origin/normalization changes must not reinterpret this matrix
+    m_currentPixelTransform = movingToFixedTransform();
+    
+    // The overlay re-warps the visible area with the next frame
+    updateWarpOverlay();
+    
+    // Per-point residuals against the new transform, kept live while editing
+    m_residualTransform = m_currentPixelTransform;
+    m_hasResidualTransform = true;
+    updateResiduals();
     
     // Display results
     QString resultText;
@@ -1181,11 +1663,17 @@ void MainWindow::onLoadLabelCompleted(const LabelData &result)
         return;
     }
     
-    // Clear and restore tie points
-    m_tiePointModel->clearAll();
-    for (const auto &pair : result.tiePoints) {
-        m_tiePointModel->addTiePoint(pair.first, pair.second);
+    // Clear and restore tie points in one batch
+    QList<TiePointPair> pairs;
+    pairs.reserve(result.tiePoints.size());
+    for (const auto &point : result.tiePoints) {
+        TiePointPair pair;
+        pair.fixed = point.first;
+        pair.moving = point.second;
+        pairs.append(pair);
     }
+    clearTiePoints();
+    m_tiePointModel->appendPairs(pairs);
     
     // Store transform results
     m_hasValidTransform = true;
@@ -1196,6 +1684,12 @@ void MainWindow::onLoadLabelCompleted(const LabelData &result)
     m_currentScaleY = result.rigid.scale_y;
     m_currentShear = result.rigid.shear;
     m_currentMatrix = result.matrix3x3;
+    m_currentPixelTransform = movingToFixedTransform();
+    
+    // Residuals of the loaded points against the loaded transform
+    m_residualTransform = m_currentPixelTransform;
+    m_hasResidualTransform = true;
+    updateResiduals();
     
     // Display results
     QString resultText;
@@ -1290,83 +1784,153 @@ void MainWindow::showAbout()
 
 void MainWindow::updateImageViews()
 {
-    // Update fixed image
+    // Update fixed image. The tiled item is reused and paints from the
+    // model's shared handle; only a side whose image actually changed is
+    // re-tiled and re-fitted.
     if (m_imagePairModel->hasFixedImage()) {
-        if (m_fixedPixmapItem) {
-            m_fixedScene->removeItem(m_fixedPixmapItem);
-            delete m_fixedPixmapItem;
+        const ImageHandle &handle = m_imagePairModel->fixedImageHandle();
+        if (!m_fixedImageItem) {
+            m_fixedImageItem = new TiledImageItem();
+            m_fixedScene->addItem(m_fixedImageItem);
+        }
+        if (m_fixedImageItem->handle() != handle) {
+            m_fixedImageItem->setImage(handle);
+            ui->fixedImageView->fitInView(m_fixedImageItem, Qt::KeepAspectRatio);
+            syncContrastControls();
         }
-        m_fixedPixmapItem = m_fixedScene->addPixmap(QPixmap::fromImage(m_imagePairModel->fixedImage()));
-        ui->fixedImageView->fitInView(m_fixedPixmapItem, Qt::KeepAspectRatio);
     }
     
     // Update moving image
     if (m_imagePairModel->hasMovingImage()) {
-        if (m_movingPixmapItem) {
-            m_movingScene->removeItem(m_movingPixmapItem);
-            delete m_movingPixmapItem;
+        const ImageHandle &handle = m_imagePairModel->movingImageHandle();
+        if (!m_movingImageItem) {
+            m_movingImageItem = new TiledImageItem();
+            m_movingScene->addItem(m_movingImageItem);
+        }
+        if (m_movingImageItem->handle() != handle) {
+            m_movingImageItem->setImage(handle);
+            ui->movingImageView->fitInView(m_movingImageItem, Qt::KeepAspectRatio);
+            syncContrastControls();
         }
-        m_movingPixmapItem = m_movingScene->addPixmap(QPixmap::fromImage(m_imagePairModel->movingImage()));
-        ui->movingImageView->fitInView(m_movingPixmapItem, Qt::KeepAspectRatio);
     }
     
     // Update coordinate offsets for TiePointModel display
     updateTiePointModelCoordinateOffsets();
     
+    updateWarpOverlay();
     updateActionStates();
 }
 
 void MainWindow::updateTiePointViews()
 {
+    // Full rebuild, only after a model reset; other changes are incremental
     updatePointDisplay();
-    m_pointCountLabel->setText(tr("Points: %1").arg(m_tiePointModel->count()));
-    ui->lblPointCount->setText(tr("Points: %1 (min 2 required)").arg(m_tiePointModel->count()));
+    updateResiduals();
     updateActionStates();
 }
 
-void MainWindow::updatePointDisplay()
+void MainWindow::onTiePointRowsInserted(const QModelIndex &parent, int first, int last)
 {
-    // Clear existing point markers
-    for (QGraphicsItemGroup *item : m_fixedPointMarkers) {
-        m_fixedScene->removeItem(item);
-        delete item;
+    Q_UNUSED(parent);
+    if (!m_fixedMarkerItem || !m_movingMarkerItem) {
+        updatePointDisplay();
+        updateActionStates();
+        return;
     }
-    m_fixedPointMarkers.clear();
     
-    for (QGraphicsItemGroup *item : m_movingPointMarkers) {
-        m_movingScene->removeItem(item);
-        delete item;
+    m_fixedMarkerItem->insertRows(first, last - first + 1);
+    m_movingMarkerItem->insertRows(first, last - first + 1);
+    for (int row = first; row <= last; ++row)
+        syncPointMarkers(row);
+    updateRowResiduals(first, last);
+    updatePointCountLabels();
+    updateActionStates();
+}
+
+void MainWindow::onTiePointRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(parent);
+    if (!m_fixedMarkerItem || !m_movingMarkerItem) {
+        updatePointDisplay();
+        updateActionStates();
+        return;
     }
-    m_movingPointMarkers.clear();
     
-    // Get current selection
-    QModelIndexList selected = ui->tiePointsTable->selectionModel()->selectedRows();
-    QSet<int> selectedRows;
-    for (const QModelIndex &index : selected) {
-        selectedRows.insert(index.row());
+    m_fixedMarkerItem->removeRows(first, last - first + 1);
+    m_movingMarkerItem->removeRows(first, last - first + 1);
+    updatePointCountLabels();
+    updateActionStates();
+}
+
+void MainWindow::onTiePointDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                                       const QList<int> &roles)
+{
+    // Point edits report all roles; a role list means only the coordinate
+    // text changed (origin mode, center offsets) and the markers stay put
+    if (!roles.isEmpty())
+        return;
+    
+    if (!m_fixedMarkerItem || !m_movingMarkerItem) {
+        updatePointDisplay();
+        updateActionStates();
+        return;
     }
     
-    // Add new point markers with colors - use new getAllPairs() API
-    QList<TiePointPair> pairs = m_tiePointModel->getAllPairs();
-    for (int i = 0; i < pairs.size(); ++i) {
-        const TiePointPair &pair = pairs[i];
-        QColor color = m_pointColors[i % m_pointColors.size()];
-        bool isSelected = selectedRows.contains(i);
-        
-        // Only draw fixed marker if fixed point exists
-        if (pair.hasFixed()) {
-            QGraphicsItemGroup *fixedMarker = createCrosshairMarker(m_fixedScene, pair.fixed.value(), color, isSelected, i);
-            m_fixedPointMarkers.append(fixedMarker);
-        }
-        
-        // Only draw moving marker if moving point exists
-        if (pair.hasMoving()) {
-            QGraphicsItemGroup *movingMarker = createCrosshairMarker(m_movingScene, pair.moving.value(), color, isSelected, i);
-            m_movingPointMarkers.append(movingMarker);
-        }
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+        syncPointMarkers(row);
+    updateRowResiduals(topLeft.row(), bottomRight.row());
+    // A point added to or removed from a pair changes the complete count
+    updatePointCountLabels();
+    updateActionStates();
+}
+
+void MainWindow::updatePointDisplay()
+{
+    // One marker item per scene, above the image
+    if (!m_fixedMarkerItem) {
+        m_fixedMarkerItem = new TiePointMarkerItem();
+        m_fixedMarkerItem->setZValue(1);
+        m_fixedMarkerItem->setPalette(m_pointColors);
+        m_fixedScene->addItem(m_fixedMarkerItem);
+    }
+    if (!m_movingMarkerItem) {
+        m_movingMarkerItem = new TiePointMarkerItem();
+        m_movingMarkerItem->setZValue(1);
+        m_movingMarkerItem->setPalette(m_pointColors);
+        m_movingScene->addItem(m_movingMarkerItem);
     }
+    m_fixedMarkerItem->setShowLabels(m_showPointLabels);
+    m_movingMarkerItem->setShowLabels(m_showPointLabels);
     
-    // Update point count display
+    // Rebuild all rows from the model and the current selection
+    int rowCount = m_tiePointModel->pairCount();
+    m_fixedMarkerItem->reset(rowCount);
+    m_movingMarkerItem->reset(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        syncPointMarkers(row);
+    }
+    const QVector<int> selectedRows = selectedModelRows();
+    m_fixedMarkerItem->setSelected(selectedRows, true);
+    m_movingMarkerItem->setSelected(selectedRows, true);
+    
+    updatePointCountLabels();
+}
+
+void MainWindow::syncPointMarkers(int row)
+{
+    // Partial pairs only have a marker on one side
+    if (m_tiePointModel->hasFixedAt(row))
+        m_fixedMarkerItem->setMarker(row, m_tiePointModel->fixedPoints()[row]);
+    else
+        m_fixedMarkerItem->clearMarker(row);
+    if (m_tiePointModel->hasMovingAt(row))
+        m_movingMarkerItem->setMarker(row, m_tiePointModel->movingPoints()[row]);
+    else
+        m_movingMarkerItem->clearMarker(row);
+}
+
+void MainWindow::updatePointCountLabels()
+{
     int completeCount = m_tiePointModel->completePairCount();
     int totalCount = m_tiePointModel->pairCount();
     if (completeCount != totalCount) {
@@ -1378,128 +1942,6 @@ void MainWindow::updatePointDisplay()
     }
 }
 
-QGraphicsItemGroup* MainWindow::createCrosshairMarker(QGraphicsScene *scene, const QPointF &pos, 
-                                                       const QColor &color, bool highlighted,
-                                                       int pointIndex)
-{
-    const double armLength = highlighted ? 14.0 : 10.0;  // Larger when highlighted
-    const double penWidth = highlighted ? 3.0 : 2.0;     // Thicker when highlighted
-    const double gapRadius = 3.0;  // Gap in center
-    const double outlineWidth = penWidth + 2.0;  // Outline is slightly thicker
-    
-    QGraphicsItemGroup *group = new QGraphicsItemGroup();
-    
-    // Make the group ignore view transformations (zoom/scale)
-    // This keeps the marker at a fixed screen size
-    group->setFlag(QGraphicsItem::ItemIgnoresTransformations, true);
-    
-    // Create contrasting outline color (inverted/complementary)
-    QColor outlineColor = QColor(255 - color.red(), 255 - color.green(), 255 - color.blue());
-    // Make outline darker or lighter depending on the color brightness
-    int brightness = (color.red() + color.green() + color.blue()) / 3;
-    if (brightness > 128) {
-        outlineColor = Qt::black;
-    } else {
-        outlineColor = Qt::white;
-    }
-    
-    QPen outlinePen(outlineColor, outlineWidth);
-    outlinePen.setCapStyle(Qt::RoundCap);
-    QPen mainPen(color, penWidth);
-    mainPen.setCapStyle(Qt::RoundCap);
-    
-    // If highlighted, draw a selection circle first (behind everything)
-    if (highlighted) {
-        const double circleRadius = 18.0;  // Selection circle radius
-        QGraphicsEllipseItem *selectionCircle = new QGraphicsEllipseItem(
-            -circleRadius, -circleRadius, circleRadius * 2, circleRadius * 2);
-        QPen circlePen(outlineColor, 2.0, Qt::DashLine);
-        selectionCircle->setPen(circlePen);
-        selectionCircle->setBrush(Qt::NoBrush);
-        group->addToGroup(selectionCircle);
-    }
-    
-    // Draw outline first (behind the main lines)
-    // Horizontal line (left part) - outline
-    QGraphicsLineItem *hLineLeftOut = new QGraphicsLineItem(-armLength, 0, -gapRadius, 0);
-    hLineLeftOut->setPen(outlinePen);
-    group->addToGroup(hLineLeftOut);
-    
-    // Horizontal line (right part) - outline
-    QGraphicsLineItem *hLineRightOut = new QGraphicsLineItem(gapRadius, 0, armLength, 0);
-    hLineRightOut->setPen(outlinePen);
-    group->addToGroup(hLineRightOut);
-    
-    // Vertical line (top part) - outline
-    QGraphicsLineItem *vLineTopOut = new QGraphicsLineItem(0, -armLength, 0, -gapRadius);
-    vLineTopOut->setPen(outlinePen);
-    group->addToGroup(vLineTopOut);
-    
-    // Vertical line (bottom part) - outline
-    QGraphicsLineItem *vLineBottomOut = new QGraphicsLineItem(0, gapRadius, 0, armLength);
-    vLineBottomOut->setPen(outlinePen);
-    group->addToGroup(vLineBottomOut);
-    
-    // Draw main colored lines on top
-    // Horizontal line (left part)
-    QGraphicsLineItem *hLineLeft = new QGraphicsLineItem(-armLength, 0, -gapRadius, 0);
-    hLineLeft->setPen(mainPen);
-    group->addToGroup(hLineLeft);
-    
-    // Horizontal line (right part)
-    QGraphicsLineItem *hLineRight = new QGraphicsLineItem(gapRadius, 0, armLength, 0);
-    hLineRight->setPen(mainPen);
-    group->addToGroup(hLineRight);
-    
-    // Vertical line (top part)
-    QGraphicsLineItem *vLineTop = new QGraphicsLineItem(0, -armLength, 0, -gapRadius);
-    vLineTop->setPen(mainPen);
-    group->addToGroup(vLineTop);
-    
-    // Vertical line (bottom part)
-    QGraphicsLineItem *vLineBottom = new QGraphicsLineItem(0, gapRadius, 0, armLength);
-    vLineBottom->setPen(mainPen);
-    group->addToGroup(vLineBottom);
-    
-    // Add a small center dot with outline
-    QGraphicsEllipseItem *centerDotOutline = new QGraphicsEllipseItem(-3, -3, 6, 6);
-    centerDotOutline->setPen(Qt::NoPen);
-    centerDotOutline->setBrush(outlineColor);
-    group->addToGroup(centerDotOutline);
-    
-    QGraphicsEllipseItem *centerDot = new QGraphicsEllipseItem(-2, -2, 4, 4);
-    centerDot->setPen(Qt::NoPen);
-    centerDot->setBrush(color);
-    group->addToGroup(centerDot);
-    
-    // Add point index label if enabled and pointIndex is valid
-    if (m_showPointLabels && pointIndex >= 0) {
-        QGraphicsSimpleTextItem *label = new QGraphicsSimpleTextItem(QString::number(pointIndex + 1));
-        QFont font = label->font();
-        font.setPointSize(9);
-        font.setBold(true);
-        label->setFont(font);
-        label->setBrush(color);
-        // Position label to the right of the crosshair
-        label->setPos(armLength + 3, -armLength);
-        group->addToGroup(label);
-        
-        // Add text outline for better visibility
-        QGraphicsSimpleTextItem *labelOutline = new QGraphicsSimpleTextItem(QString::number(pointIndex + 1));
-        labelOutline->setFont(font);
-        labelOutline->setBrush(outlineColor);
-        labelOutline->setPos(armLength + 2, -armLength - 1);
-        labelOutline->setZValue(-1);  // Behind the main label
-        group->addToGroup(labelOutline);
-    }
-    
-    // Position the group at the scene coordinates
-    group->setPos(pos);
-    
-    scene->addItem(group);
-    return group;
-}
-
 void MainWindow::updatePendingPointMarker()
 {
     // No longer needed - partial points are now shown directly in updatePointDisplay()
@@ -1521,37 +1963,36 @@ QColor MainWindow::getNextPointColor() const
     return m_pointColors[nextIndex % m_pointColors.size()];
 }
 
-void MainWindow::updateCursorMarker(QGraphicsScene *scene, const QPointF &pos)
+void MainWindow::updateCursorMarker(ImageView *view, const QPointF &pos)
 {
-    // If cursor marker exists in a different scene, remove it first
-    if (m_cursorMarker && m_cursorMarkerScene != scene) {
-        clearCursorMarker();
-    }
-    
-    QColor color = getNextPointColor();
-    
-    if (!m_cursorMarker) {
-        // Create new cursor marker
-        m_cursorMarker = createCrosshairMarker(scene, pos, color, false);
-        m_cursorMarkerScene = scene;
-        // Make cursor marker semi-transparent to distinguish from placed points
-        m_cursorMarker->setOpacity(0.7);
-    } else {
-        // Update position directly using setPos (since we use ItemIgnoresTransformations)
-        m_cursorMarker->setPos(pos);
-    }
+    // Drawn as a view overlay: moving it only repaints two small rects
+    ImageView *otherView = (view == ui->fixedImageView) ? ui->movingImageView : ui->fixedImageView;
+    otherView->clearCursorMarker();
+    view->setCursorMarker(pos, getNextPointColor());
 }
 
 void MainWindow::clearCursorMarker()
 {
-    if (m_cursorMarker) {
-        if (m_cursorMarkerScene) {
-            m_cursorMarkerScene->removeItem(m_cursorMarker);
-        }
-        delete m_cursorMarker;
-        m_cursorMarker = nullptr;
-        m_cursorMarkerScene = nullptr;
+    ui->fixedImageView->clearCursorMarker();
+    ui->movingImageView->clearCursorMarker();
+}
+
+void MainWindow::updateLoupe(QGraphicsView *view, const QPointF &viewportPos)
+{
+    TiledImageItem *item = (view == ui->fixedImageView) ? m_fixedImageItem : m_movingImageItem;
+    if (!ui->actionShowLoupe->isChecked() || !item || item->isNull()) {
+        m_loupe->hide();
+        return;
     }
+    
+    // Subpixel position; item coordinates are source pixels
+    const QPointF scenePos = view->viewportTransform().inverted().map(viewportPos);
+    m_loupe->setSource(item);
+    m_loupe->setCrosshairColor(m_isAddingPoint ? getNextPointColor() : QColor(Qt::white));
+    const QPointF sourcePos = item->mapFromScene(scenePos);
+    m_loupe->showAt(sourcePos, pixelToDisplayCoord(sourcePos, view == ui->fixedImageView),
+                    view->viewport()->mapToGlobal(viewportPos.toPoint()),
+                    QRect(view->viewport()->mapToGlobal(QPoint(0, 0)), view->viewport()->size()));
 }
 
 void MainWindow::updateActionStates()
@@ -1612,14 +2053,14 @@ QPointF MainWindow::pixelToDisplayCoord(const QPointF &pixelPos, bool isFixed) c
     
     // Convert to center-origin coordinates
     double centerX = 0, centerY = 0;
-    if (isFixed && m_fixedPixmapItem) {
-        QPixmap pm = m_fixedPixmapItem->pixmap();
-        centerX = pm.width() / 2.0;
-        centerY = pm.height() / 2.0;
-    } else if (!isFixed && m_movingPixmapItem) {
-        QPixmap pm = m_movingPixmapItem->pixmap();
-        centerX = pm.width() / 2.0;
-        centerY = pm.height() / 2.0;
+    if (isFixed && m_imagePairModel->hasFixedImage()) {
+        const QSize size = m_imagePairModel->fixedImageSize();
+        centerX = size.width() / 2.0;
+        centerY = size.height() / 2.0;
+    } else if (!isFixed && m_imagePairModel->hasMovingImage()) {
+        const QSize size = m_imagePairModel->movingImageSize();
+        centerX = size.width() / 2.0;
+        centerY = size.height() / 2.0;
     }
     
     return QPointF(pixelPos.x() - centerX, pixelPos.y() - centerY);
@@ -1688,13 +2129,54 @@ void MainWindow::showSuccessToast(const QString &message, int durationMs)
 // Image Navigation
 // ============================================================================
 
-QStringList MainWindow::getImageFilesInDir(const QString &dir)
+void MainWindow::onFixedFilesIndexed()
 {
-    QDir directory(dir);
-    QStringList filters;
-    filters << "*.png" << "*.jpg" << "*.jpeg" << "*.bmp" << "*.tif" << "*.tiff";
-    QStringList files = directory.entryList(filters, QDir::Files, QDir::Name);
-    return files;
+    // During a project restore the index runs ahead of the displayed directory
+    if (m_fixedDirIndex->directory() != m_fixedImageDir)
+        return;
+    
+    // Files are inserted in sort order, so the current image is found by name
+    QString current;
+    if (m_fixedImageIndex >= 0 && m_fixedImageIndex < m_fixedImageFiles.size())
+        current = m_fixedImageFiles[m_fixedImageIndex];
+    m_fixedImageFiles = m_fixedDirIndex->files();
+    m_fixedImageIndex = current.isEmpty() ? -1 : m_fixedImageFiles.indexOf(current);
+    
+    m_filmstripDock->setFixedFiles(m_fixedImageDir, m_fixedImageFiles);
+    m_filmstripDock->setCurrentFixedIndex(m_fixedImageIndex);
+    if (m_fixedImageIndex >= 0) {
+        ui->lblFixedFileName->setText(tr("%1 (%2/%3)")
+            .arg(current)
+            .arg(m_fixedImageIndex + 1)
+            .arg(m_fixedImageFiles.size()));
+    }
+    prefetchNeighborImages();
+    updateActionStates();
+}
+
+void MainWindow::onMovingFilesIndexed()
+{
+    // During a project restore the index runs ahead of the displayed directory
+    if (m_movingDirIndex->directory() != m_movingImageDir)
+        return;
+    
+    // Files are inserted in sort order, so the current image is found by name
+    QString current;
+    if (m_movingImageIndex >= 0 && m_movingImageIndex < m_movingImageFiles.size())
+        current = m_movingImageFiles[m_movingImageIndex];
+    m_movingImageFiles = m_movingDirIndex->files();
+    m_movingImageIndex = current.isEmpty() ? -1 : m_movingImageFiles.indexOf(current);
+    
+    m_filmstripDock->setMovingFiles(m_movingImageDir, m_movingImageFiles);
+    m_filmstripDock->setCurrentMovingIndex(m_movingImageIndex);
+    if (m_movingImageIndex >= 0) {
+        ui->lblMovingFileName->setText(tr("%1 (%2/%3)")
+            .arg(current)
+            .arg(m_movingImageIndex + 1)
+            .arg(m_movingImageFiles.size()));
+    }
+    prefetchNeighborImages();
+    updateActionStates();
 }
 
 void MainWindow::loadFixedImageByIndex(int index)
@@ -1703,20 +2185,23 @@ void MainWindow::loadFixedImageByIndex(int index)
         return;
     
     QString fileName = m_fixedImageDir + "/" + m_fixedImageFiles[index];
-    if (m_imagePairModel->loadFixedImage(fileName)) {
-        m_fixedImageIndex = index;
-        // Update filename label
-        ui->lblFixedFileName->setText(tr("%1 (%2/%3)")
-            .arg(m_fixedImageFiles[index])
-            .arg(index + 1)
-            .arg(m_fixedImageFiles.size()));
-        statusBar()->showMessage(tr("Fixed image loaded: %1 (%2/%3)")
-            .arg(m_fixedImageFiles[index])
-            .arg(index + 1)
-            .arg(m_fixedImageFiles.size()), 3000);
-    } else {
-        showError(tr("Error"), tr("Failed to load fixed image."));
-    }
+    
+    // The index advances immediately so that repeated Next/Prev clicks step
+    // from the latest request; a newer request cancels this decode
+    m_fixedImageIndex = index;
+    m_imagePairModel->requestFixedImage(fileName);
+    prefetchNeighborImages();
+    m_filmstripDock->setCurrentFixedIndex(index);
+    
+    // Update filename label
+    ui->lblFixedFileName->setText(tr("%1 (%2/%3)")
+        .arg(m_fixedImageFiles[index])
+        .arg(index + 1)
+        .arg(m_fixedImageFiles.size()));
+    statusBar()->showMessage(tr("Loading fixed image: %1 (%2/%3)...")
+        .arg(m_fixedImageFiles[index])
+        .arg(index + 1)
+        .arg(m_fixedImageFiles.size()));
     updateActionStates();
 }
 
@@ -1726,20 +2211,98 @@ void MainWindow::loadMovingImageByIndex(int index)
         return;
     
     QString fileName = m_movingImageDir + "/" + m_movingImageFiles[index];
-    if (m_imagePairModel->loadMovingImage(fileName)) {
-        m_movingImageIndex = index;
-        // Update filename label
-        ui->lblMovingFileName->setText(tr("%1 (%2/%3)")
-            .arg(m_movingImageFiles[index])
-            .arg(index + 1)
-            .arg(m_movingImageFiles.size()));
-        statusBar()->showMessage(tr("Moving image loaded: %1 (%2/%3)")
-            .arg(m_movingImageFiles[index])
-            .arg(index + 1)
-            .arg(m_movingImageFiles.size()), 3000);
-    } else {
-        showError(tr("Error"), tr("Failed to load moving image."));
+    
+    // The index advances immediately so that repeated Next/Prev clicks step
+    // from the latest request; a newer request cancels this decode
+    m_movingImageIndex = index;
+    m_imagePairModel->requestMovingImage(fileName);
+    prefetchNeighborImages();
+    m_filmstripDock->setCurrentMovingIndex(index);
+    
+    // Update filename label
+    ui->lblMovingFileName->setText(tr("%1 (%2/%3)")
+        .arg(m_movingImageFiles[index])
+        .arg(index + 1)
+        .arg(m_movingImageFiles.size()));
+    statusBar()->showMessage(tr("Loading moving image: %1 (%2/%3)...")
+        .arg(m_movingImageFiles[index])
+        .arg(index + 1)
+        .arg(m_movingImageFiles.size()));
+    updateActionStates();
+}
+
+void MainWindow::prefetchNeighborImages()
+{
+    const int radius = AppConfig::instance().prefetchRadius();
+    QStringList paths;
+    
+    auto pathAt = [](const QString &dir, const QStringList &files, int index) -> QString {
+        return (index >= 0 && index < files.size()) ? dir + "/" + files[index] : QString();
+    };
+    
+    // The current images are decoded by ImagePairModel itself; keep them in the
+    // wanted set only if the model is waiting on a prefetch job for them
+    for (const QString &current : {pathAt(m_fixedImageDir, m_fixedImageFiles, m_fixedImageIndex),
+                                   pathAt(m_movingImageDir, m_movingImageFiles, m_movingImageIndex)}) {
+        if (!current.isEmpty() && m_imageCache->isPending(current))
+            paths.append(current);
     }
+    
+    // Nearest first, forward before backward (Next is the common direction)
+    for (int d = 1; d <= radius; ++d) {
+        for (int offset : {d, -d}) {
+            QString fixedPath = pathAt(m_fixedImageDir, m_fixedImageFiles, m_fixedImageIndex + offset);
+            QString movingPath = pathAt(m_movingImageDir, m_movingImageFiles, m_movingImageIndex + offset);
+            if (m_fixedImageIndex >= 0 && !fixedPath.isEmpty())
+                paths.append(fixedPath);
+            if (m_movingImageIndex >= 0 && !movingPath.isEmpty())
+                paths.append(movingPath);
+        }
+    }
+    
+    m_imageCache->prefetch(paths);
+}
+
+void MainWindow::onFixedImageLoaded(const QString &path)
+{
+    statusBar()->showMessage(tr("Fixed image loaded: %1").arg(QFileInfo(path).fileName()), 3000);
+    onRestoreImageSettled(true);
+}
+
+void MainWindow::onMovingImageLoaded(const QString &path)
+{
+    statusBar()->showMessage(tr("Moving image loaded: %1").arg(QFileInfo(path).fileName()), 3000);
+    onRestoreImageSettled(false);
+}
+
+void MainWindow::onFixedImageRefined(const QString &path)
+{
+    Q_UNUSED(path);
+    if (m_fixedImageItem)
+        m_fixedImageItem->refineImage(m_imagePairModel->fixedImageHandle());
+}
+
+void MainWindow::onMovingImageRefined(const QString &path)
+{
+    Q_UNUSED(path);
+    if (m_movingImageItem)
+        m_movingImageItem->refineImage(m_imagePairModel->movingImageHandle());
+    updateWarpOverlay();
+}
+
+void MainWindow::onFixedImageLoadFailed(const QString &path)
+{
+    onRestoreImageSettled(true);
+    statusBar()->clearMessage();
+    showError(tr("Error"), tr("Failed to load fixed image.") + "\n" + path);
+    updateActionStates();
+}
+
+void MainWindow::onMovingImageLoadFailed(const QString &path)
+{
+    onRestoreImageSettled(false);
+    statusBar()->clearMessage();
+    showError(tr("Error"), tr("Failed to load moving image.") + "\n" + path);
     updateActionStates();
 }
 
@@ -1752,7 +2315,7 @@ void MainWindow::prevFixedImage()
     saveProjectState();
     
     // Clear current tie points and transform
-    m_tiePointModel->clearAll();
+    clearTiePoints();
     m_hasValidTransform = false;
     ui->txtResult->clear();
     
@@ -1768,7 +2331,7 @@ void MainWindow::nextFixedImage()
     saveProjectState();
     
     // Clear current tie points and transform
-    m_tiePointModel->clearAll();
+    clearTiePoints();
     m_hasValidTransform = false;
     ui->txtResult->clear();
     
@@ -1784,7 +2347,7 @@ void MainWindow::prevMovingImage()
     saveProjectState();
     
     // Clear current tie points and transform
-    m_tiePointModel->clearAll();
+    clearTiePoints();
     m_hasValidTransform = false;
     ui->txtResult->clear();
     
@@ -1800,13 +2363,45 @@ void MainWindow::nextMovingImage()
     saveProjectState();
     
     // Clear current tie points and transform
-    m_tiePointModel->clearAll();
+    clearTiePoints();
     m_hasValidTransform = false;
     ui->txtResult->clear();
     
     loadMovingImageByIndex(m_movingImageIndex + 1);
 }
 
+void MainWindow::goToFixedImage(int index)
+{
+    if (index < 0 || index >= m_fixedImageFiles.size() || index == m_fixedImageIndex)
+        return;
+    
+    // Save current tie points before switching
+    saveProjectState();
+    
+    // Clear current tie points and transform
+    clearTiePoints();
+    m_hasValidTransform = false;
+    ui->txtResult->clear();
+    
+    loadFixedImageByIndex(index);
+}
+
+void MainWindow::goToMovingImage(int index)
+{
+    if (index < 0 || index >= m_movingImageFiles.size() || index == m_movingImageIndex)
+        return;
+    
+    // Save current tie points before switching
+    saveProjectState();
+    
+    // Clear current tie points and transform
+    clearTiePoints();
+    m_hasValidTransform = false;
+    ui->txtResult->clear();
+    
+    loadMovingImageByIndex(index);
+}
+
 void MainWindow::prevPair()
 {
     // Check if we can go back for both images
@@ -1817,7 +2412,7 @@ void MainWindow::prevPair()
     saveProjectState();
     
     // Clear current tie points and transform
-    m_tiePointModel->clearAll();
+    clearTiePoints();
     m_hasValidTransform = false;
     ui->txtResult->clear();
     
@@ -1843,7 +2438,7 @@ void MainWindow::nextPair()
     saveProjectState();
     
     // Clear current tie points and transform
-    m_tiePointModel->clearAll();
+    clearTiePoints();
     m_hasValidTransform = false;
     ui->txtResult->clear();
     
@@ -1862,28 +2457,14 @@ void MainWindow::nextPair()
 
 int MainWindow::findPointAtPosition(QGraphicsView *view, const QPointF &scenePos)
 {
-    const double hitRadius = 10.0;
-    QList<TiePoint> points = m_tiePointModel->getAllTiePoints();
+    // The marker item hit-tests in screen pixels and covers partial pairs too
+    TiePointMarkerItem *markers = (view == ui->fixedImageView) ? m_fixedMarkerItem
+                                : (view == ui->movingImageView) ? m_movingMarkerItem : nullptr;
+    if (!markers)
+        return -1;
     
-    if (view == ui->fixedImageView) {
-        for (int i = 0; i < points.size(); ++i) {
-            QPointF pointPos = points[i].fixed;
-            double dist = QLineF(scenePos, pointPos).length();
-            if (dist <= hitRadius) {
-                return i;
-            }
-        }
-    } else if (view == ui->movingImageView) {
-        for (int i = 0; i < points.size(); ++i) {
-            QPointF pointPos = points[i].moving;
-            double dist = QLineF(scenePos, pointPos).length();
-            if (dist <= hitRadius) {
-                return i;
-            }
-        }
-    }
-    
-    return -1;
+    const qreal scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(view->transform());
+    return markers->markerAt(scenePos, scale);
 }
 
 void MainWindow::handleRubberBandSelection(QGraphicsView *view, const QRect &rubberBandRect)
@@ -1894,21 +2475,28 @@ void MainWindow::handleRubberBandSelection(QGraphicsView *view, const QRect &rub
     QRectF sceneRect(topLeft, bottomRight);
     sceneRect = sceneRect.normalized();
     
-    QList<TiePoint> points = m_tiePointModel->getAllTiePoints();
-    QItemSelection selection;
+    TiePointMarkerItem *markers = (view == ui->fixedImageView) ? m_fixedMarkerItem : m_movingMarkerItem;
+    if (!markers)
+        return;
     
-    for (int i = 0; i < points.size(); ++i) {
-        QPointF pointPos;
-        if (view == ui->fixedImageView) {
-            pointPos = points[i].fixed;
-        } else {
-            pointPos = points[i].moving;
-        }
-        
-        if (sceneRect.contains(pointPos)) {
-            QModelIndex index = m_tiePointModel->index(i, 0);
-            selection.select(index, index);
-        }
+    // Table rows of the markers, merged into contiguous ranges
+    QVector<int> rows;
+    for (int row : markers->markersIn(sceneRect)) {
+        const int tableRow = m_tiePointProxy->proxyRow(row);
+        if (tableRow >= 0)
+            rows.append(tableRow);
+    }
+    std::sort(rows.begin(), rows.end());
+    
+    QItemSelection selection;
+    const int lastColumn = TiePointModel::ColCount - 1;
+    for (int i = 0; i < rows.size();) {
+        int j = i + 1;
+        while (j < rows.size() && rows.at(j) == rows.at(j - 1) + 1)
+            ++j;
+        selection.append(QItemSelectionRange(m_tiePointProxy->index(rows.at(i), 0),
+                                             m_tiePointProxy->index(rows.at(j - 1), lastColumn)));
+        i = j;
     }
     
     if (!selection.isEmpty()) {
@@ -1917,16 +2505,218 @@ void MainWindow::handleRubberBandSelection(QGraphicsView *view, const QRect &rub
     }
 }
 
+void MainWindow::beginPointDrag(QGraphicsView *view, int row, bool isFixed, const QPoint &viewportPos)
+{
+    m_dragPending = true;
+    m_isDraggingPoint = false;
+    m_dragPairIndex = m_tiePointModel->getPairIndexAt(row);
+    m_dragIsFixed = isFixed;
+    m_dragPressPos = viewportPos;
+    m_dragFrom = isFixed ? m_tiePointModel->fixedPoints()[row] : m_tiePointModel->movingPoints()[row];
+    // The point keeps its offset from the cursor instead of jumping to it
+    m_dragGrabOffset = m_dragFrom - view->mapToScene(viewportPos);
+}
+
+void MainWindow::updatePointDrag(QGraphicsView *view, const QPoint &viewportPos)
+{
+    const int dragged = dragRow();
+    if (dragged < 0) {
+        finishPointDrag(true);
+        return;
+    }
+    
+    if (!m_isDraggingPoint) {
+        if ((viewportPos - m_dragPressPos).manhattanLength() < QApplication::startDragDistance())
+            return;
+        m_isDraggingPoint = true;
+        view->setCursor(Qt::SizeAllCursor);
+        
+        // Only the dragged pair's residual changes from here on, so the
+        // others are summed once and the RMS is O(1) per move
+        m_dragOtherSumSq = 0.0;
+        m_dragOtherCount = 0;
+        for (int row = 0; row < m_tiePointModel->pairCount(); ++row) {
+            const float residual = m_tiePointModel->residualAt(row);
+            if (row != dragged && !qIsNaN(residual)) {
+                m_dragOtherSumSq += double(residual) * residual;
+                ++m_dragOtherCount;
+            }
+        }
+    }
+    
+    // The model reports one row; its marker and residual follow in place
+    const QPointF pos = view->mapToScene(viewportPos) + m_dragGrabOffset;
+    m_tiePointModel->movePointDirect(m_dragPairIndex, m_dragIsFixed, pos);
+    
+    const int firstColumn = m_dragIsFixed ? TiePointModel::ColFixedX : TiePointModel::ColMovingX;
+    QString message = tr("Point #%1: (%2, %3)")
+        .arg(dragged + 1)
+        .arg(m_tiePointModel->index(dragged, firstColumn).data().toString())
+        .arg(m_tiePointModel->index(dragged, firstColumn + 1).data().toString());
+    const float residual = m_tiePointModel->residualAt(dragged);
+    if (!qIsNaN(residual)) {
+        const double rms = std::sqrt((m_dragOtherSumSq + double(residual) * residual) / (m_dragOtherCount + 1));
+        message += "  " + tr("Residual: %1 px  RMS: %2 px").arg(residual, 0, 'f', 2).arg(rms, 0, 'f', 2);
+    }
+    statusBar()->showMessage(message);
+}
+
+void MainWindow::finishPointDrag(bool cancel)
+{
+    const bool wasDragging = m_isDraggingPoint;
+    m_dragPending = false;
+    m_isDraggingPoint = false;
+    if (!wasDragging)
+        return;
+    
+    ui->fixedImageView->setCursor(Qt::ArrowCursor);
+    ui->movingImageView->setCursor(Qt::ArrowCursor);
+    
+    // The pair may have been removed under the drag: nothing to put back
+    const int dragged = dragRow();
+    if (dragged < 0) {
+        statusBar()->showMessage(tr("Point move cancelled"), 2000);
+        return;
+    }
+    
+    const QPointF to = m_dragIsFixed ? m_tiePointModel->fixedPoints()[dragged]
+                                     : m_tiePointModel->movingPoints()[dragged];
+    if (cancel || to == m_dragFrom) {
+        m_tiePointModel->movePointDirect(m_dragPairIndex, m_dragIsFixed, m_dragFrom);
+        statusBar()->showMessage(tr("Point move cancelled"), 2000);
+        return;
+    }
+    
+    // The whole drag is one undo step; its redo re-applies the final position
+    pushUndoCommand(new MovePointCommand(m_tiePointModel, m_dragPairIndex, m_dragIsFixed, m_dragFrom, to));
+    m_hasValidTransform = false;
+    updateActionStates();
+    statusBar()->showMessage(tr("Point #%1 moved.").arg(dragged + 1), 2000);
+    
+    // Recompute once after the drag, debounced like a completed pair
+    if (m_realtimeComputeEnabled && m_tiePointModel->completePairCount() >= 3) {
+        m_realtimeComputeTimer->start();
+        m_realtimeComputePending = true;
+    }
+}
+
+int MainWindow::dragRow() const
+{
+    const int row = m_tiePointModel->rowOf(m_dragPairIndex);
+    if (row < 0)
+        return -1;
+    const bool hasSide = m_dragIsFixed ? m_tiePointModel->hasFixedAt(row) : m_tiePointModel->hasMovingAt(row);
+    return hasSide ? row : -1;
+}
+
+float MainWindow::pairResidual(int row) const
+{
+    if (!m_hasResidualTransform || !m_tiePointModel->isCompleteAt(row))
+        return qQNaN();
+    const QPointF mapped = m_residualTransform.map(m_tiePointModel->movingPoints()[row]);
+    return float(QLineF(mapped, m_tiePointModel->fixedPoints()[row]).length());
+}
+
+void MainWindow::updateResiduals()
+{
+    const int rowCount = m_tiePointModel->pairCount();
+    QVector<float> residuals(rowCount);
+    for (int row = 0; row < rowCount; ++row)
+        residuals[row] = pairResidual(row);
+    m_tiePointModel->setResiduals(residuals);
+}
+
+void MainWindow::updateRowResiduals(int first, int last)
+{
+    for (int row = first; row <= last; ++row)
+        m_tiePointModel->setResidual(row, pairResidual(row));
+}
+
 // ============================================================================
 // Undo/Redo (Unified via QUndoStack)
 // ============================================================================
 
+void MainWindow::clearTiePoints()
+{
+    // Commands refer to pairs by index, so the history ends with the point
+    // set. Cleared here rather than on modelCleared: an already empty model
+    // (e.g. after Clear All) emits nothing, but its history must still go
+    m_tiePointModel->clearAll();
+    clearUndoHistory();
+}
+
+void MainWindow::clearUndoHistory()
+{
+    m_undoStack->clear();
+    m_undoSizes.clear();
+    m_undoBytes = 0;
+    // The limit is only settable while the stack is empty
+    m_undoStack->setUndoLimit(undoWindow());
+}
+
+int MainWindow::undoWindow() const
+{
+    // QUndoStack drops only its oldest command per push, and only through
+    // its undo limit; sized from the average command so far, that limit
+    // keeps the history within the budget without clearing it
+    const int maxSteps = AppConfig::instance().undoLimit();    // 0: unlimited
+    const qint64 budget = AppConfig::instance().undoMemoryBudgetBytes();
+    if (budget <= 0 || m_undoPushedCount == 0)
+        return maxSteps;
+    const qint64 average = qMax<qint64>(1, m_undoPushedBytes / m_undoPushedCount);
+    const int window = int(qBound<qint64>(1, budget / average, std::numeric_limits<int>::max()));
+    return maxSteps > 0 ? qMin(maxSteps, window) : window;
+}
+
+void MainWindow::pushUndoCommand(TiePointCommand *command)
+{
+    // Sizes are upper bounds over the done and undone states, so the running
+    // total only changes when commands are added or deleted, never on undo/redo
+    const qint64 size = command->byteSize();
+    m_undoPushedBytes += size;
+    ++m_undoPushedCount;
+    
+    // The push deletes the undone commands
+    const int kept = m_undoStack->index();
+    for (int i = kept; i < m_undoSizes.size(); ++i)
+        m_undoBytes -= m_undoSizes.at(i);
+    m_undoSizes.resize(kept);
+    
+    const qint64 budget = AppConfig::instance().undoMemoryBudgetBytes();
+    if (budget > 0) {
+        // A full window drops its oldest command on push
+        qint64 total = m_undoBytes + size;
+        const int limit = m_undoStack->undoLimit();
+        if (limit > 0 && kept >= limit)
+            total -= m_undoSizes.first();
+        if (total > budget) {
+            // Commands larger than the window was sized for: the history
+            // starts over, with a window sized from the new average
+            clearUndoHistory();
+            if (size > budget) {
+                // Too large to keep at all: applied without an undo step
+                command->redo();
+                delete command;
+                statusBar()->showMessage(tr("Change too large for the undo history; it cannot be undone."), 3000);
+                updateActionStates();
+                return;
+            }
+        }
+    }
+    
+    m_undoStack->push(command);     // Runs redo()
+    m_undoSizes.append(size);
+    m_undoBytes += size;
+    // Mirror the undo limit dropping the oldest commands
+    while (m_undoSizes.size() > m_undoStack->count())
+        m_undoBytes -= m_undoSizes.takeFirst();
+}
+
 void MainWindow::undo()
 {
     if (m_undoStack->canUndo()) {
         m_undoStack->undo();
         m_hasValidTransform = false;
-        updatePointDisplay();
         updateActionStates();
         statusBar()->showMessage(tr("Undo: %1").arg(m_undoStack->undoText()), 2000);
     }
@@ -1937,7 +2727,6 @@ void MainWindow::redo()
     if (m_undoStack->canRedo()) {
         m_undoStack->redo();
         m_hasValidTransform = false;
-        updatePointDisplay();
         updateActionStates();
         statusBar()->showMessage(tr("Redo: %1").arg(m_undoStack->redoText()), 2000);
     }
@@ -2213,15 +3002,15 @@ void MainWindow::quickExportTiePoints()
     double fixedCenterX = 0, fixedCenterY = 0;
     double movingCenterX = 0, movingCenterY = 0;
     
-    if (m_fixedPixmapItem) {
-        QPixmap pm = m_fixedPixmapItem->pixmap();
-        fixedCenterX = pm.width() / 2.0;
-        fixedCenterY = pm.height() / 2.0;
+    if (m_imagePairModel->hasFixedImage()) {
+        const QSize size = m_imagePairModel->fixedImageSize();
+        fixedCenterX = size.width() / 2.0;
+        fixedCenterY = size.height() / 2.0;
     }
-    if (m_movingPixmapItem) {
-        QPixmap pm = m_movingPixmapItem->pixmap();
-        movingCenterX = pm.width() / 2.0;
-        movingCenterY = pm.height() / 2.0;
+    if (m_imagePairModel->hasMovingImage()) {
+        const QSize size = m_imagePairModel->movingImageSize();
+        movingCenterX = size.width() / 2.0;
+        movingCenterY = size.height() / 2.0;
     }
     
     // Write header with origin mode info
@@ -2233,13 +3022,13 @@ void MainWindow::quickExportTiePoints()
     }
     out << "# Format: index, fixed_x, fixed_y, moving_x, moving_y\n";
     
-    QList<TiePointPair> pairs = m_tiePointModel->getCompletePairs();
-    int index = 1;
-    for (const TiePointPair &pair : pairs) {
-        double fx = pair.fixed->x();
-        double fy = pair.fixed->y();
-        double mx = pair.moving->x();
-        double my = pair.moving->y();
+    const QVector<double> &packed = m_tiePointModel->packedCompletePairs();
+    const int exportedCount = int(packed.size() / 4);
+    for (int index = 0; index < exportedCount; ++index) {
+        double fx = packed[4 * index];
+        double fy = packed[4 * index + 1];
+        double mx = packed[4 * index + 2];
+        double my = packed[4 * index + 3];
         
         // Convert to center origin if needed
         if (!m_useTopLeftOrigin) {
@@ -2249,8 +3038,7 @@ void MainWindow::quickExportTiePoints()
             my -= movingCenterY;
         }
         
-        out << index << "," << fx << "," << fy << "," << mx << "," << my << "\n";
-        index++;
+        out << index + 1 << "," << fx << "," << fy << "," << mx << "," << my << "\n";
     }
     
     file.close();
@@ -2294,15 +3082,15 @@ void MainWindow::exportTiePoints()
     double fixedCenterX = 0, fixedCenterY = 0;
     double movingCenterX = 0, movingCenterY = 0;
     
-    if (m_fixedPixmapItem) {
-        QPixmap pm = m_fixedPixmapItem->pixmap();
-        fixedCenterX = pm.width() / 2.0;
-        fixedCenterY = pm.height() / 2.0;
+    if (m_imagePairModel->hasFixedImage()) {
+        const QSize size = m_imagePairModel->fixedImageSize();
+        fixedCenterX = size.width() / 2.0;
+        fixedCenterY = size.height() / 2.0;
     }
-    if (m_movingPixmapItem) {
-        QPixmap pm = m_movingPixmapItem->pixmap();
-        movingCenterX = pm.width() / 2.0;
-        movingCenterY = pm.height() / 2.0;
+    if (m_imagePairModel->hasMovingImage()) {
+        const QSize size = m_imagePairModel->movingImageSize();
+        movingCenterX = size.width() / 2.0;
+        movingCenterY = size.height() / 2.0;
     }
     
     // Write header with origin mode info
@@ -2314,13 +3102,13 @@ void MainWindow::exportTiePoints()
     }
     out << "# Format: index, fixed_x, fixed_y, moving_x, moving_y\n";
     
-    QList<TiePointPair> pairs = m_tiePointModel->getCompletePairs();
-    int index = 1;
-    for (const TiePointPair &pair : pairs) {
-        double fx = pair.fixed->x();
-        double fy = pair.fixed->y();
-        double mx = pair.moving->x();
-        double my = pair.moving->y();
+    const QVector<double> &packed = m_tiePointModel->packedCompletePairs();
+    const int exportedCount = int(packed.size() / 4);
+    for (int index = 0; index < exportedCount; ++index) {
+        double fx = packed[4 * index];
+        double fy = packed[4 * index + 1];
+        double mx = packed[4 * index + 2];
+        double my = packed[4 * index + 3];
         
         // Convert to center origin if needed
         if (!m_useTopLeftOrigin) {
@@ -2330,12 +3118,11 @@ void MainWindow::exportTiePoints()
             my -= movingCenterY;
         }
         
-        out << index << "," << fx << "," << fy << "," << mx << "," << my << "\n";
-        index++;
+        out << index + 1 << "," << fx << "," << fy << "," << mx << "," << my << "\n";
     }
     
     file.close();
-    statusBar()->showMessage(tr("Exported %1 tie points to %2").arg(pairs.size()).arg(fileName), 3000);
+    statusBar()->showMessage(tr("Exported %1 tie points to %2").arg(exportedCount).arg(fileName), 3000);
 }
 
 void MainWindow::importTiePoints()
@@ -2363,19 +3150,19 @@ void MainWindow::importTiePoints()
     double fixedCenterX = 0, fixedCenterY = 0;
     double movingCenterX = 0, movingCenterY = 0;
     
-    if (m_fixedPixmapItem) {
-        QPixmap pm = m_fixedPixmapItem->pixmap();
-        fixedCenterX = pm.width() / 2.0;
-        fixedCenterY = pm.height() / 2.0;
+    if (m_imagePairModel->hasFixedImage()) {
+        const QSize size = m_imagePairModel->fixedImageSize();
+        fixedCenterX = size.width() / 2.0;
+        fixedCenterY = size.height() / 2.0;
     }
-    if (m_movingPixmapItem) {
-        QPixmap pm = m_movingPixmapItem->pixmap();
-        movingCenterX = pm.width() / 2.0;
-        movingCenterY = pm.height() / 2.0;
+    if (m_imagePairModel->hasMovingImage()) {
+        const QSize size = m_imagePairModel->movingImageSize();
+        movingCenterX = size.width() / 2.0;
+        movingCenterY = size.height() / 2.0;
     }
     
     QTextStream in(&file);
-    int importedCount = 0;
+    QList<TiePointPair> pairs;      // Added in one batch at the end
     bool fileUsesCenter = false;  // Detect from file header
     bool hasOriginInfo = false;
     
@@ -2421,15 +3208,21 @@ void MainWindow::importTiePoints()
         }
         
         // Now fx, fy, mx, my are in pixel (top-left) coordinates
-        // Add the point to model (model always stores in pixel coords)
-        m_tiePointModel->addTiePoint(QPointF(fx, fy), QPointF(mx, my));
-        importedCount++;
+        // (model always stores in pixel coords)
+        TiePointPair pair;
+        pair.fixed = QPointF(fx, fy);
+        pair.moving = QPointF(mx, my);
+        pairs.append(pair);
     }
     
     file.close();
     
+    // One undo step for the whole file
+    const int importedCount = pairs.size();
+    if (importedCount > 0)
+        pushUndoCommand(new ImportPairsCommand(m_tiePointModel, pairs));
+    
     if (importedCount > 0) {
-        updatePointDisplay();
         updateActionStates();
         statusBar()->showMessage(tr("Imported %1 tie points from %2").arg(importedCount).arg(fileName), 3000);
     } else {
@@ -2458,14 +3251,14 @@ void MainWindow::updateTiePointModelCoordinateOffsets()
     QPointF fixedOffset(0, 0);
     QPointF movingOffset(0, 0);
     
-    if (m_fixedPixmapItem) {
-        QPixmap pm = m_fixedPixmapItem->pixmap();
-        fixedOffset = QPointF(pm.width() / 2.0, pm.height() / 2.0);
+    if (m_imagePairModel->hasFixedImage()) {
+        const QSize size = m_imagePairModel->fixedImageSize();
+        fixedOffset = QPointF(size.width() / 2.0, size.height() / 2.0);
     }
     
-    if (m_movingPixmapItem) {
-        QPixmap pm = m_movingPixmapItem->pixmap();
-        movingOffset = QPointF(pm.width() / 2.0, pm.height() / 2.0);
+    if (m_imagePairModel->hasMovingImage()) {
+        const QSize size = m_imagePairModel->movingImageSize();
+        movingOffset = QPointF(size.width() / 2.0, size.height() / 2.0);
     }
     
     m_tiePointModel->setDisplayCoordinateOffset(fixedOffset, movingOffset);
@@ -2481,10 +3274,18 @@ void MainWindow::saveProjectState()
     if (m_fixedImageDir.isEmpty())
         return;
     
+    // Names survive files being added or re-sorted; the indices are a fallback
+    const QString fixedFile = (m_fixedImageIndex >= 0 && m_fixedImageIndex < m_fixedImageFiles.size())
+        ? m_fixedImageFiles[m_fixedImageIndex] : QString();
+    const QString movingFile = (m_movingImageIndex >= 0 && m_movingImageIndex < m_movingImageFiles.size())
+        ? m_movingImageFiles[m_movingImageIndex] : QString();
+    
     AppConfig::instance().saveProjectState(
         m_fixedImageDir,
         m_fixedImageIndex,
         m_movingImageIndex,
+        fixedFile,
+        movingFile,
         m_movingImageDir,
         m_matrixExportDir,
         m_tiePointsExportDir
@@ -2511,129 +3312,252 @@ void MainWindow::saveProjectState()
             out << "# RigidLabeler Tie Points Cache\n";
             out << "# Format: fixed_x, fixed_y, moving_x, moving_y (pixel coords)\n";
             
-            QList<TiePointPair> pairs = m_tiePointModel->getAllPairs();
-            for (const TiePointPair &pair : pairs) {
-                // Save all pairs, including partial ones
-                QString fx = pair.hasFixed() ? QString::number(pair.fixed->x()) : "";
-                QString fy = pair.hasFixed() ? QString::number(pair.fixed->y()) : "";
-                QString mx = pair.hasMoving() ? QString::number(pair.moving->x()) : "";
-                QString my = pair.hasMoving() ? QString::number(pair.moving->y()) : "";
-                out << fx << "," << fy << "," << mx << "," << my << "\n";
+            // Save all pairs, including partial ones (empty fields)
+            const TiePointSpan<QPointF> fixedPoints = m_tiePointModel->fixedPoints();
+            const TiePointSpan<QPointF> movingPoints = m_tiePointModel->movingPoints();
+            for (int row = 0; row < fixedPoints.size(); ++row) {
+                if (m_tiePointModel->hasFixedAt(row))
+                    out << fixedPoints[row].x() << "," << fixedPoints[row].y();
+                else
+                    out << ",";
+                out << ",";
+                if (m_tiePointModel->hasMovingAt(row))
+                    out << movingPoints[row].x() << "," << movingPoints[row].y();
+                else
+                    out << ",";
+                out << "\n";
             }
             file.close();
         }
     }
 }
 
+namespace {
+
+// Parses a tie point cache CSV (fixed_x, fixed_y, moving_x, moving_y; empty
+// fields for partial pairs)
+QList<TiePointPair> readTiePointCache(QFile &cacheFile)
+{
+    QList<TiePointPair> pairs;
+    QTextStream in(&cacheFile);
+    
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+        
+        QStringList parts = line.split(',');
+        if (parts.size() < 4)
+            continue;
+        
+        // Parse coordinates (may be empty for partial pairs)
+        bool hasFx = false, hasFy = false, hasMx = false, hasMy = false;
+        double fx = parts[0].trimmed().toDouble(&hasFx);
+        double fy = parts[1].trimmed().toDouble(&hasFy);
+        double mx = parts[2].trimmed().toDouble(&hasMx);
+        double my = parts[3].trimmed().toDouble(&hasMy);
+        
+        // Empty strings will make toDouble return false
+        hasFx = hasFx && !parts[0].trimmed().isEmpty();
+        hasFy = hasFy && !parts[1].trimmed().isEmpty();
+        hasMx = hasMx && !parts[2].trimmed().isEmpty();
+        hasMy = hasMy && !parts[3].trimmed().isEmpty();
+        
+        TiePointPair pair(pairs.size());
+        if (hasFx && hasFy)
+            pair.fixed = QPointF(fx, fy);
+        if (hasMx && hasMy)
+            pair.moving = QPointF(mx, my);
+        if (pair.hasFixed() || pair.hasMoving())
+            pairs.append(pair);
+    }
+    return pairs;
+}
+
+} // namespace
+
 void MainWindow::restoreLastProject()
 {
+    // Runs from the first event loop iteration, i.e. once the window is up
+    qDebug() << "Startup: window interactive after" << m_startupTimer.elapsed() << "ms";
+    
     QString lastProject = AppConfig::instance().lastProjectDir();
-    if (lastProject.isEmpty())
+    if (lastProject.isEmpty() || !QDir(lastProject).exists())
         return;
     
-    int fixedIndex = 0, movingIndex = 0;
-    QString movingDir, matrixDir, tiePointsDir;
-    
-    if (!AppConfig::instance().loadProjectState(lastProject, fixedIndex, movingIndex,
-                                                  movingDir, matrixDir, tiePointsDir)) {
+    PendingRestore pending;
+    pending.fixedDir = lastProject;
+    if (!AppConfig::instance().loadProjectState(lastProject, pending.fixedIndex, pending.movingIndex,
+                                                  pending.fixedFile, pending.movingFile,
+                                                  pending.movingDir, pending.matrixExportDir,
+                                                  pending.tiePointsExportDir)) {
         return;
     }
+    if (!pending.movingDir.isEmpty() && !QDir(pending.movingDir).exists())
+        pending.movingDir.clear();
+    m_pendingRestore = pending;
     
-    // Check if the directories still exist
-    if (!QDir(lastProject).exists())
+    // Stage 1: index both directories in the background. Seeded with the
+    // saved names, the images are resolved at once even in huge directories;
+    // nothing is shown until then, so navigation and saving cannot act on a
+    // half-restored project meanwhile.
+    setRestoreStage(1, tr("Restoring project: indexing %1...").arg(lastProject));
+    m_fixedDirIndex->setDirectory(pending.fixedDir, pending.fixedFile);
+    if (!pending.movingDir.isEmpty())
+        m_movingDirIndex->setDirectory(pending.movingDir, pending.movingFile);
+    continueProjectRestore();
+}
+
+void MainWindow::continueProjectRestore()
+{
+    if (m_restoreStage != 1)
         return;
     
-    // Restore fixed image directory and load file list
-    m_fixedImageDir = lastProject;
-    m_fixedImageFiles = getImageFilesInDir(m_fixedImageDir);
-    
-    if (m_fixedImageFiles.isEmpty())
+    // A saved name that is listed wins; otherwise (older settings, file
+    // removed) fall back to the saved index once the whole directory is known
+    auto resolve = [](const DirectoryIndex *index, const QString &file, int savedIndex,
+                      bool &resolved) -> QString {
+        const QStringList &files = index->files();
+        resolved = true;
+        if (!file.isEmpty() && files.contains(file))
+            return file;
+        if (index->isScanning()) {
+            resolved = false;
+            return QString();
+        }
+        return files.isEmpty() ? QString() : files[qBound(0, savedIndex, int(files.size()) - 1)];
+    };
+    
+    bool fixedResolved = false;
+    bool movingResolved = true;
+    const QString fixedFile = resolve(m_fixedDirIndex, m_pendingRestore.fixedFile,
+                                      m_pendingRestore.fixedIndex, fixedResolved);
+    QString movingFile;
+    if (!m_pendingRestore.movingDir.isEmpty()) {
+        movingFile = resolve(m_movingDirIndex, m_pendingRestore.movingFile,
+                             m_pendingRestore.movingIndex, movingResolved);
+    }
+    if (!fixedResolved || !movingResolved)
         return;
     
-    // Clamp indices to valid range
-    fixedIndex = qBound(0, fixedIndex, m_fixedImageFiles.size() - 1);
-    
-    // Load fixed image
-    loadFixedImageByIndex(fixedIndex);
+    qDebug() << "Startup: project files resolved after" << m_startupTimer.elapsed() << "ms"
+             << "(" << m_fixedDirIndex->files().size() << "fixed," << m_movingDirIndex->files().size()
+             << "moving files listed so far)";
     
-    // Restore moving image if directory exists
-    if (!movingDir.isEmpty() && QDir(movingDir).exists()) {
-        m_movingImageDir = movingDir;
-        m_movingImageFiles = getImageFilesInDir(m_movingImageDir);
-        
-        if (!m_movingImageFiles.isEmpty()) {
-            movingIndex = qBound(0, movingIndex, m_movingImageFiles.size() - 1);
-            loadMovingImageByIndex(movingIndex);
-        }
+    if (fixedFile.isEmpty()) {
+        abortProjectRestore();
+        return;
     }
     
-    // Restore export directories
-    if (!matrixDir.isEmpty() && QDir(matrixDir).exists()) {
-        m_matrixExportDir = matrixDir;
-    }
-    if (!tiePointsDir.isEmpty() && QDir(tiePointsDir).exists()) {
-        m_tiePointsExportDir = tiePointsDir;
-    }
+    // Stage 2: tie point cache (worker), then file lists and image requests
+    // (decoded asynchronously)
+    setRestoreStage(2, tr("Restoring project: loading images..."));
     
-    // Restore tie points from cache file
-    QString cacheDir = m_fixedImageDir + "/.rigidlabeler_cache";
-    QString cacheFileName;
-    if (m_fixedImageIndex >= 0 && m_fixedImageIndex < m_fixedImageFiles.size()) {
-        QFileInfo fi(m_fixedImageFiles[m_fixedImageIndex]);
-        cacheFileName = cacheDir + "/" + fi.baseName() + "_tiepoints.csv";
-    } else {
-        cacheFileName = cacheDir + "/tiepoints.csv";
-    }
-    
-    QFile cacheFile(cacheFileName);
-    if (cacheFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream in(&cacheFile);
-        int restoredCount = 0;
+    auto *watcher = new QFutureWatcher<QList<TiePointPair>>(this);
+    connect(watcher, &QFutureWatcher<QList<TiePointPair>>::finished, this,
+            [this, watcher, fixedFile, movingFile]() {
+        watcher->deleteLater();
         
-        while (!in.atEnd()) {
-            QString line = in.readLine().trimmed();
-            if (line.isEmpty() || line.startsWith('#'))
-                continue;
-            
-            QStringList parts = line.split(',');
-            if (parts.size() < 4)
-                continue;
-            
-            // Parse coordinates (may be empty for partial pairs)
-            bool hasFx = false, hasFy = false, hasMx = false, hasMy = false;
-            double fx = parts[0].trimmed().toDouble(&hasFx);
-            double fy = parts[1].trimmed().toDouble(&hasFy);
-            double mx = parts[2].trimmed().toDouble(&hasMx);
-            double my = parts[3].trimmed().toDouble(&hasMy);
-            
-            // Empty strings will make toDouble return false
-            hasFx = hasFx && !parts[0].trimmed().isEmpty();
-            hasFy = hasFy && !parts[1].trimmed().isEmpty();
-            hasMx = hasMx && !parts[2].trimmed().isEmpty();
-            hasMy = hasMy && !parts[3].trimmed().isEmpty();
-            
-            if (hasFx && hasFy && hasMx && hasMy) {
-                // Complete pair
-                m_tiePointModel->addTiePoint(QPointF(fx, fy), QPointF(mx, my));
-                restoredCount++;
-            } else if (hasFx && hasFy) {
-                // Only fixed point - use direct method for restoration
-                m_tiePointModel->addFixedPointDirect(QPointF(fx, fy));
-                restoredCount++;
-            } else if (hasMx && hasMy) {
-                // Only moving point (shouldn't happen normally)
-                restoredCount++;
-            }
+        // The user opened something else in the meantime
+        if (m_restoreStage != 2)
+            return;
+        
+        // Restore export directories
+        if (!m_pendingRestore.matrixExportDir.isEmpty() && QDir(m_pendingRestore.matrixExportDir).exists()) {
+            m_matrixExportDir = m_pendingRestore.matrixExportDir;
+        }
+        if (!m_pendingRestore.tiePointsExportDir.isEmpty() && QDir(m_pendingRestore.tiePointsExportDir).exists()) {
+            m_tiePointsExportDir = m_pendingRestore.tiePointsExportDir;
         }
-        cacheFile.close();
         
-        if (restoredCount > 0) {
-            updatePointDisplay();
-            updateActionStates();
+        // Show the listings as indexed so far; the scans keep extending them
+        m_fixedImageDir = m_pendingRestore.fixedDir;
+        m_fixedImageIndex = -1;
+        onFixedFilesIndexed();
+        const int fixedIndex = m_fixedImageFiles.indexOf(fixedFile);
+        int movingIndex = -1;
+        if (!movingFile.isEmpty()) {
+            m_movingImageDir = m_pendingRestore.movingDir;
+            m_movingImageIndex = -1;
+            onMovingFilesIndexed();
+            movingIndex = m_movingImageFiles.indexOf(movingFile);
         }
-    }
+        
+        // Removed by a rescan since it was resolved
+        if (fixedIndex < 0) {
+            abortProjectRestore();
+            return;
+        }
+        
+        // Both flags are set first: a cache hit publishes synchronously
+        m_restoreAwaitingFixed = true;
+        m_restoreAwaitingMoving = movingIndex >= 0;
+        loadFixedImageByIndex(fixedIndex);
+        if (movingIndex >= 0)
+            loadMovingImageByIndex(movingIndex);
+        
+        // Tie points are in image coordinates and need no decoded pixels
+        // (one batch, partial pairs included)
+        const int restoredCount = m_tiePointModel->appendPairs(watcher->result());
+        if (restoredCount > 0)
+            updateActionStates();
+        qDebug() << "Startup:" << restoredCount << "tie points restored after"
+                 << m_startupTimer.elapsed() << "ms";
+    });
+    
+    const QString cachePath = m_pendingRestore.fixedDir + "/.rigidlabeler_cache/"
+        + QFileInfo(fixedFile).baseName() + "_tiepoints.csv";
+    watcher->setFuture(QtConcurrent::run([cachePath]() -> QList<TiePointPair> {
+        // Restore tie points from cache file
+        QFile cacheFile(cachePath);
+        if (!cacheFile.open(QIODevice::ReadOnly | QIODevice::Text))
+            return QList<TiePointPair>();
+        return readTiePointCache(cacheFile);
+    }));
+}
+
+void MainWindow::abortProjectRestore()
+{
+    if (m_restoreStage != 1 && m_restoreStage != 2)
+        return;
+    
+    // Drop listings that were started for the restore but never shown
+    if (m_fixedDirIndex->directory() != m_fixedImageDir)
+        m_fixedDirIndex->clear();
+    if (m_movingDirIndex->directory() != m_movingImageDir)
+        m_movingDirIndex->clear();
+    
+    m_restoreAwaitingFixed = false;
+    m_restoreAwaitingMoving = false;
+    setRestoreStage(0, QString());
+}
+
+void MainWindow::setRestoreStage(int stage, const QString &message)
+{
+    // Stage 0 hides the indicator; 1-3 are indexing, images, done
+    m_restoreStage = stage;
+    m_restoreProgress->setValue(stage);
+    m_restoreProgress->setVisible(stage > 0 && stage < m_restoreProgress->maximum());
+    if (!message.isEmpty())
+        statusBar()->showMessage(message, stage == m_restoreProgress->maximum() ? 3000 : 0);
+}
+
+void MainWindow::onRestoreImageSettled(bool isFixed)
+{
+    // Only the images requested by the restore itself count
+    if (m_restoreStage != 2 || (!m_restoreAwaitingFixed && !m_restoreAwaitingMoving))
+        return;
+    
+    if (isFixed)
+        m_restoreAwaitingFixed = false;
+    else
+        m_restoreAwaitingMoving = false;
+    if (m_restoreAwaitingFixed || m_restoreAwaitingMoving)
+        return;
     
-    statusBar()->showMessage(tr("Restored last project: %1").arg(m_fixedImageDir), 3000);
+    // Stage 3: everything is on screen
+    setRestoreStage(3, tr("Restored last project: %1").arg(m_fixedImageDir));
+    qDebug() << "Startup: project restored, fully interactive after" << m_startupTimer.elapsed() << "ms";
 }
 
 void MainWindow::closeEvent(QCloseEvent *event)
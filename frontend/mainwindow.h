@@ -10,21 +10,34 @@
 #include <QUndoStack>
 #include <QTranslator>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QItemSelection>
+#include <QTransform>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
 class TiePointModel;
+class TiePointProxyModel;
+class TiePointCommand;
 class ImagePairModel;
+class ImageCache;
+class PyramidCache;
+class ThumbnailCache;
+class DirectoryIndex;
+class FilmstripDock;
+class ImageView;
+class LoupeWidget;
+class WarpOverlayItem;
+class TiledImageItem;
+class TiePointMarkerItem;
 class BackendClient;
 class QGraphicsScene;
-class QGraphicsPixmapItem;
-class QGraphicsEllipseItem;
 class QGraphicsView;
 class QGraphicsItemGroup;
-class QGraphicsLineItem;
 class PreviewDialog;
+class QProgressBar;
 
 struct ComputeRigidResult;
 struct LabelSaveResult;
@@ -63,6 +76,16 @@ private slots:
     void nextMovingImage();
     void prevPair();
     void nextPair();
+    void goToFixedImage(int index);
+    void goToMovingImage(int index);
+    
+    // Asynchronous image loading results
+    void onFixedImageLoaded(const QString &path);
+    void onMovingImageLoaded(const QString &path);
+    void onFixedImageRefined(const QString &path);
+    void onMovingImageRefined(const QString &path);
+    void onFixedImageLoadFailed(const QString &path);
+    void onMovingImageLoadFailed(const QString &path);
     
     // Label operations
     void saveLabel();
@@ -80,11 +103,20 @@ private slots:
     void zoomToFitAll();
     void toggleLinkViews(bool linked);
     
+    // Display (contrast) controls
+    void onContrastControlsChanged();
+    void autoContrast();
+    void resetContrast();
+    
     // Tie point operations
     void addTiePoint();
     void deleteSelectedTiePoint();
     void clearAllTiePoints();
-    void onTiePointSelectionChanged();
+    void onTiePointSelectionChanged(const QItemSelection &selected, const QItemSelection &deselected);
+    void onTiePointRowsInserted(const QModelIndex &parent, int first, int last);
+    void onTiePointRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onTiePointDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                               const QList<int> &roles);
     void exportTiePoints();
     void importTiePoints();
     void exportMatrix();
@@ -130,6 +162,8 @@ private:
     void updateImageViews();
     void updateTiePointViews();
     void updatePointDisplay();
+    void syncPointMarkers(int row);
+    void updatePointCountLabels();
     void updateActionStates();
     
     void showError(const QString &title, const QString &message);
@@ -145,28 +179,65 @@ private:
     QString formatDisplayCoord(const QPointF &pixelPos, bool isFixed) const;
     void updateTiePointModelCoordinateOffsets();
     
+    // Contrast control helpers
+    TiledImageItem* contrastTargetItem() const;
+    void syncContrastControls();
+    
+    // Warp overlay helpers
+    // m_currentMatrix read under the current origin settings; only called
+    // when the matrix is set (see m_currentPixelTransform)
+    QTransform movingToFixedTransform() const;
+    void updateWarpOverlay();
+    
     // Image navigation helpers
-    QStringList getImageFilesInDir(const QString &dir);
+    void onFixedFilesIndexed();
+    void onMovingFilesIndexed();
     void loadFixedImageByIndex(int index);
     void loadMovingImageByIndex(int index);
+    void prefetchNeighborImages();
+    
+    // Undo helpers
+    // Empties the tie point model and the undo history (image switch, label load)
+    void clearTiePoints();
+    // Empties the history and sizes its window anew (see undoWindow())
+    void clearUndoHistory();
+    // Undo limit that keeps an average command within the memory budget
+    int undoWindow() const;
+    void pushUndoCommand(TiePointCommand *command);
     
     // Mouse interaction helpers
     void handleRubberBandSelection(QGraphicsView *view, const QRect &rubberBandRect);
     int findPointAtPosition(QGraphicsView *view, const QPointF &scenePos);
+    // Model rows selected in the tie point table, ascending
+    QVector<int> selectedModelRows() const;
+    
+    // Marker drag helpers
+    void beginPointDrag(QGraphicsView *view, int row, bool isFixed, const QPoint &viewportPos);
+    void updatePointDrag(QGraphicsView *view, const QPoint &viewportPos);
+    void finishPointDrag(bool cancel);
+    // Row of the dragged point, -1 once its pair or that side is gone
+    int dragRow() const;
+    
+    // Residual helpers (against the last computed transform)
+    float pairResidual(int row) const;
+    void updateResiduals();
+    void updateRowResiduals(int first, int last);
     
     // Crosshair marker helpers
-    QGraphicsItemGroup* createCrosshairMarker(QGraphicsScene *scene, const QPointF &pos, 
-                                               const QColor &color, bool highlighted = false,
-                                               int pointIndex = -1);
     void updatePendingPointMarker();
     void clearPendingPointMarker();
-    void updateCursorMarker(QGraphicsScene *scene, const QPointF &pos);
+    void updateCursorMarker(ImageView *view, const QPointF &pos);
     void clearCursorMarker();
     QColor getNextPointColor() const;
+    void updateLoupe(QGraphicsView *view, const QPointF &viewportPos);
     
     // Project cache helpers
     void saveProjectState();
     void restoreLastProject();
+    void continueProjectRestore();
+    void abortProjectRestore();
+    void setRestoreStage(int stage, const QString &message);
+    void onRestoreImageSettled(bool isFixed);
     void closeEvent(QCloseEvent *event) override;
 
 private:
@@ -174,28 +245,45 @@ private:
     
     // Models
     TiePointModel *m_tiePointModel;
+    TiePointProxyModel *m_tiePointProxy;    // What the tie point table shows
     ImagePairModel *m_imagePairModel;
     
+    // Decoded image cache with neighbor prefetch (for Next/Prev navigation)
+    ImageCache *m_imageCache;
+    
+    // Decoded pyramids of large images, persisted under .rigidlabeler_cache
+    PyramidCache *m_pyramidCache;
+    
+    // Background thumbnails (persisted under .rigidlabeler_cache) and their dock
+    ThumbnailCache *m_thumbnailCache;
+    FilmstripDock *m_filmstripDock;
+    
+    // Background listings of the fixed and moving image directories
+    DirectoryIndex *m_fixedDirIndex;
+    DirectoryIndex *m_movingDirIndex;
+    
     // Backend client
     BackendClient *m_backendClient;
     
     // Graphics scenes for image views
     QGraphicsScene *m_fixedScene;
     QGraphicsScene *m_movingScene;
-    QGraphicsPixmapItem *m_fixedPixmapItem;
-    QGraphicsPixmapItem *m_movingPixmapItem;
+    TiledImageItem *m_fixedImageItem;
+    TiledImageItem *m_movingImageItem;
+    
+    // Tie point markers, one batched item per scene
+    TiePointMarkerItem *m_fixedMarkerItem;
+    TiePointMarkerItem *m_movingMarkerItem;
     
-    // Point markers on scenes (crosshair groups)
-    QList<QGraphicsItemGroup*> m_fixedPointMarkers;
-    QList<QGraphicsItemGroup*> m_movingPointMarkers;
+    // Moving image warped by the current transform, drawn in the fixed scene
+    WarpOverlayItem *m_warpOverlay;
+    
+    // Magnifier following the cursor over either view
+    LoupeWidget *m_loupe;
     
     // Pending point marker (shown when first point clicked on fixed image)
     QGraphicsItemGroup *m_pendingPointMarker;
     
-    // Mouse-following crosshair marker
-    QGraphicsItemGroup *m_cursorMarker;
-    QGraphicsScene *m_cursorMarkerScene;  // Which scene the cursor marker is in
-    
     // Color palette for point pairs
     QList<QColor> m_pointColors;
     
@@ -207,6 +295,9 @@ private:
     // Current transform result
     bool m_hasValidTransform;
     QVector<QVector<double>> m_currentMatrix;
+    // m_currentMatrix as a moving -> fixed pixel transform, read with the
+    // origin/normalization settings in effect when it was computed or loaded
+    QTransform m_currentPixelTransform;
     double m_currentTheta;
     double m_currentTx;
     double m_currentTy;
@@ -242,11 +333,27 @@ private:
     QRubberBand *m_movingRubberBand;
     QPoint m_rubberBandOrigin;
     
-    // Selected point indices (for multi-selection)
-    QSet<int> m_selectedPointIndices;
+    // Marker drag: armed on press, started past the drag distance
+    bool m_dragPending;
+    bool m_isDraggingPoint;
+    int m_dragPairIndex;            // Rows shift under edits; resolved on use
+    bool m_dragIsFixed;
+    QPoint m_dragPressPos;
+    QPointF m_dragFrom;             // Point position before the drag
+    QPointF m_dragGrabOffset;       // Point minus cursor, kept during the drag
+    double m_dragOtherSumSq;        // Squared residuals of the other pairs
+    int m_dragOtherCount;
+    
+    // Transform the residual column is measured against
+    bool m_hasResidualTransform;
+    QTransform m_residualTransform;
     
     // Undo/Redo
     QUndoStack *m_undoStack;
+    QVector<qint64> m_undoSizes;    // byteSize() per command in m_undoStack, oldest first
+    qint64 m_undoBytes;             // Sum of m_undoSizes
+    qint64 m_undoPushedBytes;       // Every command pushed this session, for the average size
+    int m_undoPushedCount;
     
     // Language/Translation
     QTranslator *m_translator;
@@ -270,6 +377,26 @@ private:
     
     // Point label display mode
     bool m_showPointLabels;
+    
+    // Staged startup: the window is shown first, then the last project is
+    // restored in the background (listing, images, tie points)
+    QElapsedTimer m_startupTimer;
+    int m_restoreStage;         // 0 idle, 1 indexing, 2 loading images, 3 done
+    struct PendingRestore {
+        QString fixedDir;
+        QString movingDir;
+        QString fixedFile;      // Saved names take precedence over the indices
+        QString movingFile;
+        int fixedIndex = 0;
+        int movingIndex = 0;
+        QString matrixExportDir;
+        QString tiePointsExportDir;
+    };
+    PendingRestore m_pendingRestore;
+    bool m_restoreAwaitingFixed;
+    bool m_restoreAwaitingMoving;
+    QProgressBar *m_restoreProgress;
+    int m_healthCheckRetries;   // A freshly launched backend may not be listening yet
 };
 
 #endif // MAINWINDOW_H
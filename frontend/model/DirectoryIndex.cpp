@@ -0,0 +1,236 @@
+#include "DirectoryIndex.h"
+#include <QCollator>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QMutex>
+#include <QPromise>
+#include <QThreadPool>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+// Sorted names found so far, handed from the scan worker to the GUI thread
+struct DirectoryScanState {
+    QMutex mutex;
+    QStringList snapshot;
+};
+
+namespace {
+
+struct ScanEntry {
+    QCollatorSortKey key;
+    QString name;
+};
+
+bool entryLessThan(const ScanEntry &a, const ScanEntry &b)
+{
+    const int order = a.key.compare(b.key);
+    // Names the collator considers equal (e.g. img_01 / img_1) keep a fixed order
+    return order != 0 ? order < 0 : a.name < b.name;
+}
+
+void scanDirectory(QPromise<void> &promise, const QString &dir, const QString &seedFile,
+                   const QSharedPointer<DirectoryScanState> &state)
+{
+    promise.setProgressRange(0, std::numeric_limits<int>::max());
+
+    // QCollator is not thread-safe: one per scan
+    QCollator collator;
+    collator.setNumericMode(true);
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+
+    std::vector<ScanEntry> sorted;
+    std::vector<ScanEntry> batch;
+    if (!seedFile.isEmpty())
+        sorted.push_back(ScanEntry{collator.sortKey(seedFile), seedFile});
+
+    int published = 0;
+    auto publish = [&]() {
+        // Merge the sorted batch in: O(n) per publish instead of a full re-sort
+        std::sort(batch.begin(), batch.end(), entryLessThan);
+        const auto middle = sorted.insert(sorted.end(), std::make_move_iterator(batch.begin()),
+                                          std::make_move_iterator(batch.end()));
+        std::inplace_merge(sorted.begin(), middle, sorted.end(), entryLessThan);
+        batch.clear();
+
+        QStringList names;
+        names.reserve(qsizetype(sorted.size()));
+        for (const ScanEntry &entry : sorted)
+            names.append(entry.name);
+        {
+            QMutexLocker locker(&state->mutex);
+            state->snapshot = names;
+        }
+        promise.setProgressValue(++published);
+    };
+
+    QElapsedTimer sincePublish;
+    sincePublish.start();
+
+    QDirIterator it(dir, DirectoryIndex::nameFilters(), QDir::Files);
+    while (it.hasNext()) {
+        if (promise.isCanceled())
+            return;
+        it.next();
+        const QString name = it.fileName();
+        if (name == seedFile)
+            continue;
+        batch.push_back(ScanEntry{collator.sortKey(name), name});
+
+        if (sincePublish.elapsed() >= 200) {
+            publish();
+            sincePublish.restart();
+        }
+    }
+    publish();
+}
+
+} // namespace
+
+DirectoryIndex::DirectoryIndex(QObject *parent)
+    : QObject(parent)
+    , m_pool(new QThreadPool(this))
+    , m_watcher(nullptr)
+    , m_incremental(false)
+    , m_rescanQueued(false)
+    , m_fsWatcher(new QFileSystemWatcher(this))
+    , m_rescanTimer(new QTimer(this))
+{
+    // Listing is I/O bound; keep it off the shared pool used for tiles
+    m_pool->setMaxThreadCount(1);
+
+    m_rescanTimer->setSingleShot(true);
+    m_rescanTimer->setInterval(500);
+    connect(m_fsWatcher, &QFileSystemWatcher::directoryChanged, m_rescanTimer, qOverload<>(&QTimer::start));
+    connect(m_rescanTimer, &QTimer::timeout, this, &DirectoryIndex::onDirectoryChanged);
+}
+
+DirectoryIndex::~DirectoryIndex()
+{
+    // A cancelled scan stops at its next entry
+    cancelScan();
+    m_pool->waitForDone();
+}
+
+QStringList DirectoryIndex::nameFilters()
+{
+    return QStringList() << "*.png" << "*.jpg" << "*.jpeg" << "*.bmp" << "*.tif" << "*.tiff";
+}
+
+void DirectoryIndex::setDirectory(const QString &dir, const QString &seedFile)
+{
+    // Same directory and the file is already known: the watcher keeps it current
+    if (dir == m_dir && !dir.isEmpty() && (seedFile.isEmpty() || m_files.contains(seedFile)))
+        return;
+
+    cancelScan();
+    m_rescanTimer->stop();
+    m_rescanQueued = false;
+    if (!m_dir.isEmpty())
+        m_fsWatcher->removePath(m_dir);
+
+    m_dir = dir;
+    m_seedFile = (!seedFile.isEmpty() && QFileInfo::exists(dir + "/" + seedFile)) ? seedFile : QString();
+    m_files = m_seedFile.isEmpty() ? QStringList() : QStringList{m_seedFile};
+    emit filesChanged();
+
+    if (m_dir.isEmpty())
+        return;
+
+    m_fsWatcher->addPath(m_dir);
+    startScan(true);
+}
+
+void DirectoryIndex::clear()
+{
+    setDirectory(QString());
+}
+
+void DirectoryIndex::startScan(bool incremental)
+{
+    cancelScan();
+
+    m_incremental = incremental;
+    m_state.reset(new DirectoryScanState);
+
+    m_watcher = new QFutureWatcher<void>(this);
+    QFutureWatcher<void> *watcher = m_watcher;
+    connect(watcher, &QFutureWatcher<void>::progressValueChanged, this, [this, watcher]() {
+        if (watcher == m_watcher)
+            onScanProgress();
+    });
+    connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher]() {
+        watcher->deleteLater();
+        if (watcher == m_watcher)
+            onScanFinished();
+    });
+
+    // A rescan starts from scratch; the seed only bridges the first scan
+    watcher->setFuture(QtConcurrent::run(m_pool, scanDirectory, m_dir,
+                                         incremental ? m_seedFile : QString(), m_state));
+}
+
+void DirectoryIndex::cancelScan()
+{
+    if (!m_watcher)
+        return;
+    // Its finished() is ignored from here on and only deletes the watcher
+    m_watcher->cancel();
+    m_watcher = nullptr;
+}
+
+void DirectoryIndex::onScanProgress()
+{
+    // Rescans replace the listing in one go, so it never shrinks midway
+    if (!m_incremental)
+        return;
+
+    QStringList snapshot;
+    {
+        QMutexLocker locker(&m_state->mutex);
+        snapshot = m_state->snapshot;
+    }
+    if (snapshot.size() == m_files.size())
+        return;
+
+    m_files = snapshot;
+    emit filesChanged();
+}
+
+void DirectoryIndex::onScanFinished()
+{
+    m_watcher = nullptr;
+
+    QStringList snapshot;
+    {
+        QMutexLocker locker(&m_state->mutex);
+        snapshot = m_state->snapshot;
+    }
+    if (snapshot != m_files) {
+        m_files = snapshot;
+        emit filesChanged();
+    }
+    emit scanFinished();
+
+    if (m_rescanQueued) {
+        m_rescanQueued = false;
+        startScan(false);
+    }
+}
+
+void DirectoryIndex::onDirectoryChanged()
+{
+    if (m_dir.isEmpty())
+        return;
+
+    // Changes seen during a scan may have been missed by it
+    if (isScanning()) {
+        m_rescanQueued = true;
+        return;
+    }
+    startScan(false);
+}
@@ -0,0 +1,73 @@
+#ifndef DIRECTORYINDEX_H
+#define DIRECTORYINDEX_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+class QFileSystemWatcher;
+class QThreadPool;
+class QTimer;
+struct DirectoryScanState;
+
+/**
+ * @brief Background, naturally sorted listing of the image files in one directory.
+ *
+ * setDirectory() returns immediately; a worker streams the directory with
+ * QDirIterator and files() grows while it runs (filesChanged() fires at most
+ * a few times per second), so navigation works long before a 100k-file
+ * network share has been listed. Names are ordered with a numeric QCollator,
+ * i.e. img_2 sorts before img_10.
+ *
+ * A QFileSystemWatcher keeps the listing current: when the directory changes,
+ * it is rescanned in the background and files() is replaced once the rescan
+ * has finished.
+ *
+ * All public methods must be called from the GUI thread.
+ */
+class DirectoryIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DirectoryIndex(QObject *parent = nullptr);
+    ~DirectoryIndex();
+
+    // seedFile (a name in dir) is listed right away, before the scan reaches it
+    void setDirectory(const QString &dir, const QString &seedFile = QString());
+    void clear();
+
+    QString directory() const { return m_dir; }
+    const QStringList &files() const { return m_files; }
+    bool isScanning() const { return m_watcher != nullptr; }
+
+    static QStringList nameFilters();
+
+signals:
+    void filesChanged();
+    void scanFinished();
+
+private:
+    void startScan(bool incremental);
+    void cancelScan();
+    void onScanProgress();
+    void onScanFinished();
+    void onDirectoryChanged();
+
+    QString m_dir;
+    QString m_seedFile;
+    QStringList m_files;
+
+    QThreadPool *m_pool;
+    QFutureWatcher<void> *m_watcher;
+    QSharedPointer<DirectoryScanState> m_state;
+    bool m_incremental;                  // Publish partial results of the current scan
+    bool m_rescanQueued;
+
+    QFileSystemWatcher *m_fsWatcher;
+    QTimer *m_rescanTimer;               // Coalesces bursts of change notifications
+};
+
+#endif // DIRECTORYINDEX_H
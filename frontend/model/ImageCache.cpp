@@ -0,0 +1,146 @@
+#include "ImageCache.h"
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QImageReader>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+
+// Set of paths the GUI thread still wants, shared with queued jobs so that a
+// job whose path has scrolled out of the prefetch window can skip its decode.
+struct ImagePrefetchWantedSet {
+    QMutex mutex;
+    QSet<QString> paths;
+
+    bool contains(const QString &path) {
+        QMutexLocker locker(&mutex);
+        return paths.contains(path);
+    }
+};
+
+ImageCache::ImageCache(QObject *parent)
+    : QObject(parent)
+    , m_budgetBytes(0)
+    , m_pool(new QThreadPool(this))
+    , m_sharedWanted(new ImagePrefetchWantedSet)
+{
+    m_pool->setMaxThreadCount(2);
+    setMemoryBudget(qint64(1024) * 1024 * 1024);  // 1 GiB default
+}
+
+ImageCache::~ImageCache()
+{
+    {
+        QMutexLocker locker(&m_sharedWanted->mutex);
+        m_sharedWanted->paths.clear();
+    }
+    m_pool->waitForDone();
+}
+
+void ImageCache::setMemoryBudget(qint64 bytes)
+{
+    m_budgetBytes = qMax<qint64>(0, bytes);
+    m_cache.setMaxCost(qsizetype(m_budgetBytes / 1024));
+}
+
+qint64 ImageCache::memoryUsage() const
+{
+    return qint64(m_cache.totalCost()) * 1024;
+}
+
+bool ImageCache::contains(const QString &path) const
+{
+    return m_cache.contains(path);
+}
+
+QImage ImageCache::image(const QString &path)
+{
+    QImage *cached = m_cache.object(path);
+    return cached ? *cached : QImage();
+}
+
+void ImageCache::insert(const QString &path, const QImage &image)
+{
+    if (image.isNull())
+        return;
+    // QCache takes ownership; images larger than the whole budget are rejected
+    m_cache.insert(path, new QImage(image), qsizetype(costOf(image) / 1024));
+}
+
+void ImageCache::clear()
+{
+    m_cache.clear();
+}
+
+qint64 ImageCache::costOf(const QImage &image)
+{
+    return qMax<qint64>(1024, qint64(image.sizeInBytes()));
+}
+
+// ============================================================================
+// Background Prefetch
+// ============================================================================
+
+void ImageCache::prefetch(const QStringList &paths)
+{
+    m_wanted = QSet<QString>(paths.begin(), paths.end());
+    {
+        QMutexLocker locker(&m_sharedWanted->mutex);
+        m_sharedWanted->paths = m_wanted;
+    }
+
+    for (const QString &path : paths) {
+        if (!m_cache.contains(path) && !m_pending.contains(path))
+            enqueue(path);
+    }
+}
+
+void ImageCache::enqueue(const QString &path)
+{
+    m_pending.insert(path);
+
+    QSharedPointer<ImagePrefetchWantedSet> wanted = m_sharedWanted;
+    auto *watcher = new QFutureWatcher<PrefetchResult>(this);
+    connect(watcher, &QFutureWatcher<PrefetchResult>::finished, this, [this, watcher, path]() {
+        watcher->deleteLater();
+        onPrefetchFinished(path, watcher->result());
+    });
+
+    watcher->setFuture(QtConcurrent::run(m_pool, [path, wanted]() -> PrefetchResult {
+        PrefetchResult result;
+        // Dropped from the window while queued: don't waste a decode
+        if (!wanted->contains(path)) {
+            result.skipped = true;
+            return result;
+        }
+        if (QFileInfo(path).isFile()) {
+            result.image = QImageReader(path).read();
+        }
+        return result;
+    }));
+}
+
+void ImageCache::onPrefetchFinished(const QString &path, const PrefetchResult &result)
+{
+    m_pending.remove(path);
+
+    if (result.skipped) {
+        // The path may have re-entered the window after the job was skipped
+        if (m_wanted.contains(path) && !m_cache.contains(path))
+            enqueue(path);
+        else
+            emit imageDropped(path);
+        return;
+    }
+
+    if (result.image.isNull()) {
+        qWarning() << "Prefetch failed to decode image:" << path;
+        emit imageFailed(path);
+        return;
+    }
+
+    insert(path, result.image);
+    emit imageReady(path, result.image);
+}
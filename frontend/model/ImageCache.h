@@ -0,0 +1,74 @@
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QSharedPointer>
+#include <QImage>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+class QThreadPool;
+struct ImagePrefetchWantedSet;
+
+/**
+ * @brief Memory-bounded LRU cache of decoded images with background prefetch.
+ *
+ * Sits in front of ImagePairModel: images are looked up by absolute file path,
+ * and neighbours of the current navigation position can be decoded ahead of
+ * time on a worker pool. Entries are evicted least-recently-used first once
+ * the configured byte budget is exceeded.
+ *
+ * All public methods must be called from the GUI thread.
+ */
+class ImageCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ImageCache(QObject *parent = nullptr);
+    ~ImageCache();
+
+    // Budget in bytes; shrinking it evicts immediately
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const { return m_budgetBytes; }
+    qint64 memoryUsage() const;
+
+    // Lookup (touches the LRU order on hit)
+    bool contains(const QString &path) const;
+    QImage image(const QString &path);
+    void insert(const QString &path, const QImage &image);
+    void clear();
+
+    // Background prefetch. Paths are decoded in the order given (nearest
+    // first); queued jobs for paths no longer wanted are dropped.
+    void prefetch(const QStringList &paths);
+    bool isPending(const QString &path) const { return m_pending.contains(path); }
+
+signals:
+    void imageReady(const QString &path, const QImage &image);
+    void imageFailed(const QString &path);
+    void imageDropped(const QString &path);   // Prefetch skipped, nothing decoded
+
+private:
+    struct PrefetchResult {
+        QImage image;
+        bool skipped = false;
+    };
+
+    static qint64 costOf(const QImage &image);
+    void enqueue(const QString &path);
+    void onPrefetchFinished(const QString &path, const PrefetchResult &result);
+
+    // QCache cost unit is KiB so that multi-GB budgets fit comfortably
+    QCache<QString, QImage> m_cache;
+    qint64 m_budgetBytes;
+
+    QThreadPool *m_pool;
+    QSet<QString> m_pending;   // Paths with a decode job queued or running
+    QSet<QString> m_wanted;    // Paths requested by the latest prefetch() call
+    QSharedPointer<ImagePrefetchWantedSet> m_sharedWanted;  // Copy visible to workers
+};
+
+#endif // IMAGECACHE_H
@@ -0,0 +1,93 @@
+#include "ImageHandle.h"
+#include "PyramidFile.h"
+#include <QAtomicInteger>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QDebug>
+
+ImageHandle::ImageHandle(const QString &path, const QImage &image, const QSize &sourceSize,
+                         bool regionDecodable, const QByteArray &format)
+{
+    QSharedPointer<Data> data(new Data);
+    data->id = nextId();
+    data->path = path;
+    data->image = image;
+    data->sourceSize = sourceSize.isValid() ? sourceSize : image.size();
+    data->regionDecodable = regionDecodable;
+    data->format = format;
+
+    QFileInfo fileInfo(path);
+    if (fileInfo.exists()) {
+        data->fileSize = fileInfo.size();
+        data->lastModified = fileInfo.lastModified();
+        if (data->format.isEmpty())
+            data->format = fileInfo.suffix().toLower().toLatin1();
+    }
+
+    d = data;
+}
+
+const QImage &ImageHandle::image() const
+{
+    static const QImage nullImage;
+    return d ? d->image : nullImage;
+}
+
+ImageHandle ImageHandle::withImage(const QImage &image) const
+{
+    if (!d)
+        return ImageHandle();
+
+    QSharedPointer<Data> data(new Data(*d));
+    data->id = nextId();
+    data->image = image;
+    // Full pixels in hand: region reads are no longer needed
+    if (image.size() == data->sourceSize)
+        data->regionDecodable = false;
+
+    ImageHandle handle;
+    handle.d = data;
+    return handle;
+}
+
+ImageHandle ImageHandle::withPyramid(const QSharedPointer<const PyramidFile> &pyramid) const
+{
+    if (!d)
+        return ImageHandle();
+
+    QSharedPointer<Data> data(new Data(*d));
+    data->id = nextId();
+    data->pyramid = pyramid;
+
+    ImageHandle handle;
+    handle.d = data;
+    return handle;
+}
+
+QImage ImageHandle::readRegion(const QRect &sourceRect, const QSize &outputSize) const
+{
+    if (!d)
+        return QImage();
+    return readRegion(d->path, sourceRect, outputSize);
+}
+
+QImage ImageHandle::readRegion(const QString &path, const QRect &sourceRect, const QSize &outputSize)
+{
+    // QImageReader applies the clip rect first, then scales the clipped region
+    QImageReader reader(path);
+    reader.setClipRect(sourceRect);
+    if (outputSize.isValid() && outputSize != sourceRect.size())
+        reader.setScaledSize(outputSize);
+
+    QImage image = reader.read();
+    if (image.isNull()) {
+        qWarning() << "Region decode error:" << path << sourceRect << reader.errorString();
+    }
+    return image;
+}
+
+quint64 ImageHandle::nextId()
+{
+    static QAtomicInteger<quint64> counter(0);
+    return counter.fetchAndAddRelaxed(1) + 1;
+}
@@ -0,0 +1,92 @@
+#ifndef IMAGEHANDLE_H
+#define IMAGEHANDLE_H
+
+#include <QDateTime>
+#include <QImage>
+#include <QRect>
+#include <QSharedPointer>
+#include <QSize>
+#include <QString>
+
+class PyramidFile;
+
+/**
+ * @brief Shared, immutable handle to one decoded image.
+ *
+ * The pixels are stored once and shared by the model, the scene item that
+ * paints them and any worker that reads them; copying a handle only bumps a
+ * reference count. Dimensions and file metadata are captured when the handle
+ * is created, so size queries never touch the pixel data.
+ *
+ * image() may be a downscaled preview of the file; size() is always the
+ * full-resolution size, i.e. the coordinate space of tie points.
+ *
+ * A handle opened from the persistent pyramid cache also carries the mapped
+ * PyramidFile, from which every level can be read tile by tile.
+ */
+class ImageHandle
+{
+public:
+    ImageHandle() = default;
+    ImageHandle(const QString &path, const QImage &image, const QSize &sourceSize = QSize(),
+                bool regionDecodable = false, const QByteArray &format = QByteArray());
+
+    bool isNull() const { return !d || d->image.isNull(); }
+
+    // Unique per handle; a refined handle gets a new id
+    quint64 id() const { return d ? d->id : 0; }
+
+    QString path() const { return d ? d->path : QString(); }
+    const QImage &image() const;
+
+    // Full-resolution dimensions
+    QSize size() const { return d ? d->sourceSize : QSize(); }
+    int width() const { return size().width(); }
+    int height() const { return size().height(); }
+    bool isPreview() const { return d && d->image.size() != d->sourceSize; }
+
+    // Metadata captured at creation
+    QByteArray format() const { return d ? d->format : QByteArray(); }
+    qint64 fileSize() const { return d ? d->fileSize : 0; }
+    QDateTime lastModified() const { return d ? d->lastModified : QDateTime(); }
+
+    // Full-resolution regions can be read on demand, with readRegion() or
+    // from the cached pyramid
+    bool isRegionDecodable() const { return d && (d->regionDecodable || d->pyramid); }
+    QSharedPointer<const PyramidFile> pyramid() const
+    {
+        return d ? d->pyramid : QSharedPointer<const PyramidFile>();
+    }
+
+    // Decode a source-pixel rectangle of the file, scaled to outputSize.
+    // Thread-safe; does not touch the shared pixels.
+    QImage readRegion(const QRect &sourceRect, const QSize &outputSize) const;
+    static QImage readRegion(const QString &path, const QRect &sourceRect, const QSize &outputSize);
+
+    // Same source and metadata, different (e.g. full-resolution) pixels
+    ImageHandle withImage(const QImage &image) const;
+    // Same image, backed by a decoded pyramid of the source
+    ImageHandle withPyramid(const QSharedPointer<const PyramidFile> &pyramid) const;
+
+    bool operator==(const ImageHandle &other) const { return id() == other.id(); }
+    bool operator!=(const ImageHandle &other) const { return id() != other.id(); }
+
+private:
+    struct Data {
+        quint64 id = 0;
+        QString path;
+        QImage image;
+        QSize sourceSize;
+        QByteArray format;
+        qint64 fileSize = 0;
+        QDateTime lastModified;
+        bool regionDecodable = false;
+        QSharedPointer<const PyramidFile> pyramid;
+    };
+
+    static quint64 nextId();
+
+    QSharedPointer<const Data> d;
+};
+
+#endif // IMAGEHANDLE_H
@@ -1,60 +1,405 @@
 #include "ImagePairModel.h"
+#include "ImageCache.h"
+#include "PyramidCache.h"
+#include "PyramidFile.h"
 #include <QFileInfo>
+#include <QImageReader>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QDebug>
 
 ImagePairModel::ImagePairModel(QObject *parent)
     : QObject(parent)
+    , m_decodePool(new QThreadPool(this))
+    , m_cache(nullptr)
+    , m_pyramidCache(nullptr)
 {
+    // One worker per side is enough: a side never has more than one live job
+    m_decodePool->setMaxThreadCount(2);
+
+    m_fixedSlot.generation.reset(new QAtomicInteger<quint64>(0));
+    m_movingSlot.generation.reset(new QAtomicInteger<quint64>(0));
+}
+
+ImagePairModel::~ImagePairModel()
+{
+    cancelPendingLoads();
+    // Jobs only touch their own captured state, but wait so no decode
+    // outlives the model during application shutdown
+    m_decodePool->waitForDone();
 }
 
 bool ImagePairModel::loadFixedImage(const QString &path)
 {
+    // A synchronous load supersedes any pending asynchronous request
+    cancelSlot(m_fixedSlot);
+
     QFileInfo fileInfo(path);
     if (!fileInfo.exists() || !fileInfo.isFile()) {
         qWarning() << "Fixed image file does not exist:" << path;
         return false;
     }
 
-    QImage image(path);
+    QImage image = decodeImage(path);
     if (image.isNull()) {
         qWarning() << "Failed to load fixed image:" << path;
         return false;
     }
 
-    m_fixedPath = path;
-    m_fixedImage = image;
-    
-    emit fixedImageChanged(path);
+    publishImage(true, ImageHandle(path, image));
     return true;
 }
 
 bool ImagePairModel::loadMovingImage(const QString &path)
 {
+    // A synchronous load supersedes any pending asynchronous request
+    cancelSlot(m_movingSlot);
+
     QFileInfo fileInfo(path);
     if (!fileInfo.exists() || !fileInfo.isFile()) {
         qWarning() << "Moving image file does not exist:" << path;
         return false;
     }
 
-    QImage image(path);
+    QImage image = decodeImage(path);
     if (image.isNull()) {
         qWarning() << "Failed to load moving image:" << path;
         return false;
     }
 
-    m_movingPath = path;
-    m_movingImage = image;
-    
-    emit movingImageChanged(path);
+    publishImage(false, ImageHandle(path, image));
     return true;
 }
 
 void ImagePairModel::clearImages()
 {
-    m_fixedPath.clear();
-    m_movingPath.clear();
-    m_fixedImage = QImage();
-    m_movingImage = QImage();
-    
+    cancelPendingLoads();
+
+    m_fixed = ImageHandle();
+    m_moving = ImageHandle();
+
     emit imagesCleared();
 }
+
+// ============================================================================
+// Asynchronous Loading
+// ============================================================================
+
+void ImagePairModel::requestFixedImage(const QString &path)
+{
+    startDecode(m_fixedSlot, path, true);
+}
+
+void ImagePairModel::requestMovingImage(const QString &path)
+{
+    startDecode(m_movingSlot, path, false);
+}
+
+void ImagePairModel::cancelPendingLoads()
+{
+    cancelSlot(m_fixedSlot);
+    cancelSlot(m_movingSlot);
+}
+
+void ImagePairModel::setImageCache(ImageCache *cache)
+{
+    if (m_cache == cache)
+        return;
+
+    if (m_cache)
+        disconnect(m_cache, nullptr, this, nullptr);
+
+    m_cache = cache;
+
+    if (m_cache) {
+        connect(m_cache, &ImageCache::imageReady, this, &ImagePairModel::onCacheImageReady);
+        connect(m_cache, &ImageCache::imageFailed, this, &ImagePairModel::onCacheImageFailed);
+        connect(m_cache, &ImageCache::imageDropped, this, &ImagePairModel::onCacheImageDropped);
+    }
+}
+
+void ImagePairModel::startDecode(LoadSlot &slot, const QString &path, bool isFixed)
+{
+    // Supersede whatever is still in flight for this side
+    cancelSlot(slot);
+
+    if (m_cache) {
+        // Cache hit: publish right away, no decode needed
+        QImage cached = m_cache->image(path);
+        if (!cached.isNull()) {
+            publishImage(isFixed, ImageHandle(path, cached));
+            return;
+        }
+        // A prefetch job is already decoding this file: wait for it, unless
+        // mapping its cached pyramid is quicker
+        if (m_cache->isPending(path)
+                && !(m_pyramidCache && QFileInfo::exists(PyramidCache::cacheFilePath(QFileInfo(path))))) {
+            slot.pendingPath = path;
+            slot.awaitingCache = true;
+            return;
+        }
+    }
+
+    const quint64 generation = slot.generation->loadAcquire();
+    QSharedPointer<QAtomicInteger<quint64>> latest = slot.generation;
+    const bool usePyramids = (m_pyramidCache != nullptr);
+
+    slot.pendingPath = path;
+    slot.watcher = new QFutureWatcher<ImageHandle>(this);
+    QFutureWatcher<ImageHandle> *watcher = slot.watcher;
+
+    connect(watcher, &QFutureWatcher<ImageHandle>::finished, this, [this, watcher, isFixed, generation, path]() {
+        watcher->deleteLater();
+        onDecodeFinished(isFixed, generation, path);
+    });
+
+    watcher->setFuture(QtConcurrent::run(m_decodePool, [path, generation, latest, usePyramids]() -> ImageHandle {
+        // Skip the decode entirely if the user already moved on
+        if (latest->loadAcquire() != generation)
+            return ImageHandle();
+
+        QFileInfo fileInfo(path);
+        if (!fileInfo.exists() || !fileInfo.isFile())
+            return ImageHandle();
+
+        // Seen before: map the decoded pyramid instead of decompressing
+        if (usePyramids) {
+            const QSharedPointer<const PyramidFile> pyramid = PyramidCache::lookup(path);
+            if (pyramid) {
+                ImageHandle handle = openPyramid(path, pyramid);
+                if (!handle.isNull())
+                    return handle;
+            }
+        }
+
+        return decodeFirstPass(path);
+    }));
+}
+
+void ImagePairModel::startRefine(LoadSlot &slot, const QString &path, bool isFixed)
+{
+    // Same generation as the preview: a newer request cancels both
+    const quint64 generation = slot.generation->loadAcquire();
+    QSharedPointer<QAtomicInteger<quint64>> latest = slot.generation;
+
+    slot.refineWatcher = new QFutureWatcher<QImage>(this);
+    QFutureWatcher<QImage> *watcher = slot.refineWatcher;
+
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, isFixed, generation, path]() {
+        watcher->deleteLater();
+        onRefineFinished(isFixed, generation, path);
+    });
+
+    watcher->setFuture(QtConcurrent::run(m_decodePool, [path, generation, latest]() -> QImage {
+        if (latest->loadAcquire() != generation)
+            return QImage();
+        return decodeImage(path);
+    }));
+}
+
+void ImagePairModel::cancelSlot(LoadSlot &slot)
+{
+    // Bumping the generation invalidates any queued or running job;
+    // its result is discarded in onDecodeFinished()
+    slot.generation->fetchAndAddOrdered(1);
+
+    if (slot.watcher) {
+        slot.watcher->cancel();
+        slot.watcher = nullptr;
+    }
+    if (slot.refineWatcher) {
+        slot.refineWatcher->cancel();
+        slot.refineWatcher = nullptr;
+    }
+    slot.awaitingCache = false;
+    slot.pendingPath.clear();
+}
+
+void ImagePairModel::onDecodeFinished(bool isFixed, quint64 generation, const QString &path)
+{
+    LoadSlot &slot = isFixed ? m_fixedSlot : m_movingSlot;
+
+    // Stale job: a newer request (or a cancel) has replaced it
+    if (slot.generation->loadAcquire() != generation)
+        return;
+
+    QFutureWatcher<ImageHandle> *watcher = slot.watcher;
+    slot.watcher = nullptr;
+    slot.pendingPath.clear();
+
+    ImageHandle handle;
+    if (watcher && !watcher->isCanceled())
+        handle = watcher->result();
+
+    if (handle.isNull()) {
+        qWarning() << (isFixed ? "Failed to load fixed image:" : "Failed to load moving image:") << path;
+        if (isFixed)
+            emit fixedImageLoadFailed(path);
+        else
+            emit movingImageLoadFailed(path);
+        return;
+    }
+
+    // The cache only holds full-resolution images
+    if (m_cache && !handle.isPreview())
+        m_cache->insert(path, handle.image());
+
+    publishImage(isFixed, handle);
+
+    // Preview without clip-rect support: fetch the full image in the background
+    if (handle.isPreview() && !handle.isRegionDecodable())
+        startRefine(slot, path, isFixed);
+}
+
+void ImagePairModel::onRefineFinished(bool isFixed, quint64 generation, const QString &path)
+{
+    LoadSlot &slot = isFixed ? m_fixedSlot : m_movingSlot;
+
+    if (slot.generation->loadAcquire() != generation)
+        return;
+
+    QFutureWatcher<QImage> *watcher = slot.refineWatcher;
+    slot.refineWatcher = nullptr;
+
+    QImage image;
+    if (watcher && !watcher->isCanceled())
+        image = watcher->result();
+
+    // Keep showing the preview if the full decode fails
+    ImageHandle &current = isFixed ? m_fixed : m_moving;
+    if (image.isNull() || image.size() != current.size()) {
+        qWarning() << "Full-resolution decode failed, keeping preview:" << path;
+        return;
+    }
+
+    if (m_cache)
+        m_cache->insert(path, image);
+
+    // The preview handle is released here; the full pixels are the only copy
+    current = current.withImage(image);
+    storePyramid(current);
+    if (isFixed)
+        emit fixedImageRefined(path);
+    else
+        emit movingImageRefined(path);
+}
+
+void ImagePairModel::onCacheImageReady(const QString &path, const QImage &image)
+{
+    for (LoadSlot *slot : {&m_fixedSlot, &m_movingSlot}) {
+        if (slot->awaitingCache && slot->pendingPath == path) {
+            const bool isFixed = (slot == &m_fixedSlot);
+            slot->awaitingCache = false;
+            slot->pendingPath.clear();
+            publishImage(isFixed, ImageHandle(path, image));
+        }
+    }
+}
+
+void ImagePairModel::onCacheImageFailed(const QString &path)
+{
+    for (LoadSlot *slot : {&m_fixedSlot, &m_movingSlot}) {
+        if (slot->awaitingCache && slot->pendingPath == path) {
+            const bool isFixed = (slot == &m_fixedSlot);
+            slot->awaitingCache = false;
+            slot->pendingPath.clear();
+            if (isFixed)
+                emit fixedImageLoadFailed(path);
+            else
+                emit movingImageLoadFailed(path);
+        }
+    }
+}
+
+void ImagePairModel::onCacheImageDropped(const QString &path)
+{
+    // The prefetch we were waiting on was skipped: decode it ourselves
+    if (m_fixedSlot.awaitingCache && m_fixedSlot.pendingPath == path)
+        requestFixedImage(path);
+    if (m_movingSlot.awaitingCache && m_movingSlot.pendingPath == path)
+        requestMovingImage(path);
+}
+
+void ImagePairModel::publishImage(bool isFixed, const ImageHandle &handle)
+{
+    storePyramid(handle);
+
+    if (isFixed) {
+        m_fixed = handle;
+        emit fixedImageChanged(handle.path());
+    } else {
+        m_moving = handle;
+        emit movingImageChanged(handle.path());
+    }
+}
+
+void ImagePairModel::storePyramid(const ImageHandle &handle)
+{
+    // Only full decodes are worth persisting; previews come from fast decoders
+    if (m_pyramidCache && !handle.isNull() && !handle.isPreview() && !handle.pyramid())
+        m_pyramidCache->store(handle.path(), handle.image());
+}
+
+QImage ImagePairModel::decodeImage(const QString &path)
+{
+    QImageReader reader(path);
+    QImage image = reader.read();
+    if (image.isNull()) {
+        qWarning() << "Image decode error:" << path << reader.errorString();
+    }
+    return image;
+}
+
+ImageHandle ImagePairModel::decodeFirstPass(const QString &path)
+{
+    QImageReader reader(path);
+    const QByteArray format = reader.format();
+    const QSize sourceSize = reader.size();
+    const QSize preview = previewSize(sourceSize);
+
+    // Only worth a separate pass if the handler scales while decoding;
+    // otherwise QImageReader would decode full size and scale afterwards
+    if (sourceSize.isValid() && preview != sourceSize
+            && reader.supportsOption(QImageIOHandler::ScaledSize)) {
+        const bool regionDecodable = reader.supportsOption(QImageIOHandler::ClipRect);
+        reader.setScaledSize(preview);
+        QImage image = reader.read();
+        if (!image.isNull())
+            return ImageHandle(path, image, sourceSize, regionDecodable, format);
+        qWarning() << "Scaled decode failed, falling back to full decode:" << path << reader.errorString();
+    }
+
+    QImage image = decodeImage(path);
+    if (image.isNull())
+        return ImageHandle();
+    return ImageHandle(path, image, image.size(), false, format);
+}
+
+ImageHandle ImagePairModel::openPyramid(const QString &path, const QSharedPointer<const PyramidFile> &pyramid)
+{
+    // The preview level is one of the pyramid's levels (same halving)
+    const QSize sourceSize = pyramid->sourceSize();
+    const QSize preview = previewSize(sourceSize);
+    for (int level = 0; level < pyramid->levelCount(); ++level) {
+        if (pyramid->levelSize(level) != preview)
+            continue;
+        const QImage image = pyramid->levelImage(level);
+        if (image.isNull())
+            break;
+        return ImageHandle(path, image, sourceSize).withPyramid(pyramid);
+    }
+
+    qWarning() << "Pyramid cache: no preview level for" << path << sourceSize;
+    return ImageHandle();
+}
+
+QSize ImagePairModel::previewSize(const QSize &sourceSize)
+{
+    // Same halving as the view's tile pyramid, so the preview is exactly one
+    // of its levels
+    QSize size = sourceSize;
+    while (size.width() > PreviewMaxSide || size.height() > PreviewMaxSide) {
+        size = QSize(qMax(1, (size.width() + 1) / 2), qMax(1, (size.height() + 1) / 2));
+    }
+    return size;
+}
@@ -4,45 +4,152 @@
 #include <QObject>
 #include <QString>
 #include <QImage>
+#include <QSize>
+#include <QSharedPointer>
+#include <QAtomicInteger>
+#include <QFutureWatcher>
+#include "ImageHandle.h"
+
+class QThreadPool;
+class ImageCache;
+class PyramidCache;
+class PyramidFile;
 
 /**
  * @brief Model for managing a pair of images (fixed and moving).
- * 
+ *
  * Handles loading, storing, and providing access to the image pair
  * used for registration labeling.
+ *
+ * Images can be loaded synchronously (loadFixedImage/loadMovingImage) or
+ * asynchronously (requestFixedImage/requestMovingImage). Asynchronous decoding
+ * runs on a private worker pool; a newer request for the same side cancels the
+ * older one, so only the most recently requested image is ever published.
+ *
+ * If an ImageCache is attached, requests are served from it when possible and
+ * attach to an in-flight prefetch of the same file instead of decoding twice.
+ *
+ * Large images whose reader can scale while decoding (JPEG) are first published
+ * as a power-of-two downscaled preview no larger than PreviewMaxSide, so the
+ * view can paint immediately. fixedImageSize()/movingImageSize() always report
+ * the full-resolution size, which is the coordinate space of tie points. If the
+ * reader can also clip while decoding, full-resolution pixels are never decoded
+ * as a whole; the view reads visible regions through ImageHandle::readRegion().
+ * Otherwise the full image is decoded in the background and published through
+ * fixedImageRefined/movingImageRefined.
+ *
+ * Each side is held as a single ImageHandle; the scene items paint from the
+ * same shared pixels rather than keeping their own copy.
+ *
+ * If a PyramidCache is attached, fully decoded large images are written to it,
+ * and a later request for the same file version maps the cached pyramid
+ * instead of decoding: the handle gets the preview level as its image and the
+ * pyramid for everything finer.
  */
 class ImagePairModel : public QObject
 {
     Q_OBJECT
 
 public:
+    // Longest side of the downscaled first-pass image
+    static constexpr int PreviewMaxSide = 2048;
+
     explicit ImagePairModel(QObject *parent = nullptr);
+    ~ImagePairModel();
 
-    // Image loading
+    // Image loading (blocking, decodes on the calling thread)
     bool loadFixedImage(const QString &path);
     bool loadMovingImage(const QString &path);
     void clearImages();
 
+    // Asynchronous image loading (decodes on a worker thread).
+    // fixedImageChanged/movingImageChanged fire when the image is ready,
+    // fixedImageLoadFailed/movingImageLoadFailed if it cannot be decoded.
+    void requestFixedImage(const QString &path);
+    void requestMovingImage(const QString &path);
+    void cancelPendingLoads();
+
+    // Optional decoded-image cache (not owned)
+    void setImageCache(ImageCache *cache);
+    ImageCache *imageCache() const { return m_cache; }
+
+    // Optional persistent pyramid cache (not owned)
+    void setPyramidCache(PyramidCache *cache) { m_pyramidCache = cache; }
+    PyramidCache *pyramidCache() const { return m_pyramidCache; }
+
     // Getters
-    QString fixedImagePath() const { return m_fixedPath; }
-    QString movingImagePath() const { return m_movingPath; }
-    const QImage& fixedImage() const { return m_fixedImage; }
-    const QImage& movingImage() const { return m_movingImage; }
-    
-    bool hasFixedImage() const { return !m_fixedImage.isNull(); }
-    bool hasMovingImage() const { return !m_movingImage.isNull(); }
+    const ImageHandle& fixedImageHandle() const { return m_fixed; }
+    const ImageHandle& movingImageHandle() const { return m_moving; }
+    QString fixedImagePath() const { return m_fixed.path(); }
+    QString movingImagePath() const { return m_moving.path(); }
+    const QImage& fixedImage() const { return m_fixed.image(); }
+    const QImage& movingImage() const { return m_moving.image(); }
+
+    // Full-resolution size (fixedImage() may be a smaller preview)
+    QSize fixedImageSize() const { return m_fixed.size(); }
+    QSize movingImageSize() const { return m_moving.size(); }
+    bool isFixedImagePreview() const { return m_fixed.isPreview(); }
+    bool isMovingImagePreview() const { return m_moving.isPreview(); }
+
+    bool hasFixedImage() const { return !m_fixed.isNull(); }
+    bool hasMovingImage() const { return !m_moving.isNull(); }
     bool hasBothImages() const { return hasFixedImage() && hasMovingImage(); }
 
+    // Pending asynchronous loads
+    bool isFixedImageLoading() const { return m_fixedSlot.watcher || m_fixedSlot.awaitingCache; }
+    bool isMovingImageLoading() const { return m_movingSlot.watcher || m_movingSlot.awaitingCache; }
+    QString pendingFixedImagePath() const { return m_fixedSlot.pendingPath; }
+    QString pendingMovingImagePath() const { return m_movingSlot.pendingPath; }
+
+    // Size of the first-pass preview for an image of the given size
+    // (halved until it fits PreviewMaxSide; returns sourceSize if it already fits)
+    static QSize previewSize(const QSize &sourceSize);
+
 signals:
     void fixedImageChanged(const QString &path);
     void movingImageChanged(const QString &path);
+    // Full-resolution pixels replaced a preview of the same file
+    void fixedImageRefined(const QString &path);
+    void movingImageRefined(const QString &path);
+    void fixedImageLoadFailed(const QString &path);
+    void movingImageLoadFailed(const QString &path);
     void imagesCleared();
 
 private:
-    QString m_fixedPath;
-    QString m_movingPath;
-    QImage m_fixedImage;
-    QImage m_movingImage;
+    // Per-side bookkeeping for asynchronous decoding.
+    // The generation counter is shared with the worker so that a job which has
+    // been superseded can bail out before decoding.
+    struct LoadSlot {
+        QSharedPointer<QAtomicInteger<quint64>> generation;
+        QFutureWatcher<ImageHandle> *watcher = nullptr;
+        QFutureWatcher<QImage> *refineWatcher = nullptr;   // Full decode after a preview
+        QString pendingPath;
+        bool awaitingCache = false;   // Waiting on an ImageCache prefetch job
+    };
+
+    void startDecode(LoadSlot &slot, const QString &path, bool isFixed);
+    void startRefine(LoadSlot &slot, const QString &path, bool isFixed);
+    void cancelSlot(LoadSlot &slot);
+    void onDecodeFinished(bool isFixed, quint64 generation, const QString &path);
+    void onRefineFinished(bool isFixed, quint64 generation, const QString &path);
+    void onCacheImageReady(const QString &path, const QImage &image);
+    void onCacheImageFailed(const QString &path);
+    void onCacheImageDropped(const QString &path);
+    void publishImage(bool isFixed, const ImageHandle &handle);
+    void storePyramid(const ImageHandle &handle);
+
+    static QImage decodeImage(const QString &path);
+    static ImageHandle decodeFirstPass(const QString &path);
+    static ImageHandle openPyramid(const QString &path, const QSharedPointer<const PyramidFile> &pyramid);
+
+    ImageHandle m_fixed;
+    ImageHandle m_moving;
+
+    QThreadPool *m_decodePool;
+    ImageCache *m_cache;
+    PyramidCache *m_pyramidCache;
+    LoadSlot m_fixedSlot;
+    LoadSlot m_movingSlot;
 };
 
 #endif // IMAGEPAIRMODEL_H
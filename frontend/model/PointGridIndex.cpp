@@ -0,0 +1,139 @@
+#include "PointGridIndex.h"
+#include <QLineF>
+#include <QtMath>
+
+PointGridIndex::PointGridIndex(qreal cellSize)
+    : m_cellSize(qMax<qreal>(1.0, cellSize))
+    , m_count(0)
+{
+}
+
+quint64 PointGridIndex::cellKey(int cx, int cy)
+{
+    return (quint64(quint32(cx)) << 32) | quint32(cy);
+}
+
+int PointGridIndex::cellCoord(qreal v) const
+{
+    return int(qFloor(v / m_cellSize));
+}
+
+void PointGridIndex::clear()
+{
+    m_cells.clear();
+    m_count = 0;
+}
+
+void PointGridIndex::insert(int row, const QPointF &pos)
+{
+    Cell &cell = m_cells[cellKey(cellCoord(pos.x()), cellCoord(pos.y()))];
+    cell.entries.append(Entry{row, pos});
+    cell.sum += pos;
+    ++m_count;
+}
+
+void PointGridIndex::remove(int row, const QPointF &pos)
+{
+    auto it = m_cells.find(cellKey(cellCoord(pos.x()), cellCoord(pos.y())));
+    if (it == m_cells.end())
+        return;
+
+    Cell &cell = it.value();
+    for (int i = 0; i < cell.entries.size(); ++i) {
+        if (cell.entries[i].row == row) {
+            cell.sum -= cell.entries[i].pos;
+            cell.entries.removeAt(i);
+            --m_count;
+            break;
+        }
+    }
+    if (cell.entries.isEmpty())
+        m_cells.erase(it);
+}
+
+void PointGridIndex::shiftRows(int fromRow, int delta)
+{
+    if (delta == 0)
+        return;
+    for (Cell &cell : m_cells) {
+        for (Entry &entry : cell.entries) {
+            if (entry.row >= fromRow)
+                entry.row += delta;
+        }
+    }
+}
+
+template <typename Visit>
+void PointGridIndex::forEachCellIn(const QRectF &rect, Visit visit) const
+{
+    const int x0 = cellCoord(rect.left());
+    const int x1 = cellCoord(rect.right());
+    const int y0 = cellCoord(rect.top());
+    const int y1 = cellCoord(rect.bottom());
+
+    // Zoomed far out the area may span more cells than are occupied
+    const qint64 spanned = qint64(x1 - x0 + 1) * (y1 - y0 + 1);
+    if (spanned > m_cells.size()) {
+        for (auto it = m_cells.constBegin(); it != m_cells.constEnd(); ++it) {
+            const int cx = int(qint32(quint32(it.key() >> 32)));
+            const int cy = int(qint32(quint32(it.key())));
+            if (cx >= x0 && cx <= x1 && cy >= y0 && cy <= y1)
+                visit(it.value());
+        }
+        return;
+    }
+
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            auto it = m_cells.constFind(cellKey(cx, cy));
+            if (it != m_cells.constEnd())
+                visit(it.value());
+        }
+    }
+}
+
+template <typename Visit>
+void PointGridIndex::forEachEntryIn(const QRectF &rect, Visit visit) const
+{
+    forEachCellIn(rect, [&](const Cell &cell) {
+        for (const Entry &entry : cell.entries) {
+            if (rect.contains(entry.pos))
+                visit(entry);
+        }
+    });
+}
+
+int PointGridIndex::nearest(const QPointF &pos, qreal radius) const
+{
+    int best = -1;
+    qreal bestDistance = radius;
+    const QRectF area(pos.x() - radius, pos.y() - radius, 2 * radius, 2 * radius);
+    forEachEntryIn(area, [&](const Entry &entry) {
+        const qreal distance = QLineF(pos, entry.pos).length();
+        // Ties go to the lower row, as a linear scan would
+        if (distance < bestDistance || (distance == bestDistance && (best < 0 || entry.row < best))) {
+            bestDistance = distance;
+            best = entry.row;
+        }
+    });
+    return best;
+}
+
+QVector<int> PointGridIndex::rowsIn(const QRectF &rect) const
+{
+    QVector<int> rows;
+    forEachEntryIn(rect.normalized(), [&](const Entry &entry) {
+        rows.append(entry.row);
+    });
+    return rows;
+}
+
+QVector<PointGridIndex::CellSummary> PointGridIndex::cellsIn(const QRectF &rect) const
+{
+    QVector<CellSummary> cells;
+    forEachCellIn(rect.normalized(), [&](const Cell &cell) {
+        const int count = int(cell.entries.size());
+        cells.append(CellSummary{cell.sum / count, count, cell.entries.first().row});
+    });
+    return cells;
+}
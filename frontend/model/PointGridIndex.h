@@ -0,0 +1,72 @@
+#ifndef POINTGRIDINDEX_H
+#define POINTGRIDINDEX_H
+
+#include <QHash>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+/**
+ * @brief Uniform-grid spatial index of tie point positions, keyed by table row.
+ *
+ * Positions (image pixel coordinates) are bucketed into square cells held in
+ * a hash, so the grid is sparse and unbounded. Nearest-within-radius and
+ * rectangle queries only visit the cells the query area overlaps (or, for
+ * very large areas, the occupied cells), independent of the total point count.
+ *
+ * Entries are identified by the tie point model row; shiftRows() follows row
+ * insertions and removals so results always match the table.
+ *
+ * Each cell also keeps its entry count and position sum, so cellsIn() can
+ * summarize an area for level-of-detail drawing without touching entries.
+ */
+class PointGridIndex
+{
+public:
+    struct CellSummary {
+        QPointF centroid;
+        int count;
+        int row;        // Of one entry; the only one when count == 1
+    };
+
+    explicit PointGridIndex(qreal cellSize = 128.0);
+
+    void clear();
+    void insert(int row, const QPointF &pos);
+    void remove(int row, const QPointF &pos);
+    // Adds delta to every row >= fromRow
+    void shiftRows(int fromRow, int delta);
+    int size() const { return m_count; }
+    qreal cellSize() const { return m_cellSize; }
+
+    // Row of the entry nearest to pos within radius, or -1
+    int nearest(const QPointF &pos, qreal radius) const;
+    // Rows of the entries inside rect
+    QVector<int> rowsIn(const QRectF &rect) const;
+    // Occupied cells overlapping rect (their points may lie just outside it)
+    QVector<CellSummary> cellsIn(const QRectF &rect) const;
+
+private:
+    struct Entry {
+        int row;
+        QPointF pos;
+    };
+
+    struct Cell {
+        QVector<Entry> entries;
+        QPointF sum;
+    };
+
+    static quint64 cellKey(int cx, int cy);
+    int cellCoord(qreal v) const;
+    template <typename Visit>
+    void forEachCellIn(const QRectF &rect, Visit visit) const;
+    template <typename Visit>
+    void forEachEntryIn(const QRectF &rect, Visit visit) const;
+
+    qreal m_cellSize;
+    QHash<quint64, Cell> m_cells;
+    int m_count;
+};
+
+#endif // POINTGRIDINDEX_H
@@ -0,0 +1,109 @@
+#include "PyramidCache.h"
+#include "PyramidFile.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+
+PyramidCache::PyramidCache(QObject *parent)
+    : QObject(parent)
+    , m_writePool(new QThreadPool(this))
+    , m_diskBudget(qint64(4096) * 1024 * 1024)
+{
+    // Writing is I/O bound and must never hold up decoding or tiles
+    m_writePool->setMaxThreadCount(1);
+}
+
+PyramidCache::~PyramidCache()
+{
+    // A half-written QSaveFile is discarded, but let the current write finish
+    m_writePool->clear();
+    m_writePool->waitForDone();
+}
+
+void PyramidCache::setDiskBudget(qint64 bytes)
+{
+    m_diskBudget = qMax<qint64>(0, bytes);
+}
+
+QString PyramidCache::cacheFilePath(const QFileInfo &fileInfo)
+{
+    // A changed file gets a new key; its old pyramid ages out through the LRU
+    const QByteArray key = fileInfo.absoluteFilePath().toUtf8() + '|'
+        + QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch()) + '|'
+        + QByteArray::number(fileInfo.size());
+    const QString name = QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex());
+    return fileInfo.absolutePath() + "/.rigidlabeler_cache/pyramids/" + name + ".rlpyr";
+}
+
+QSharedPointer<const PyramidFile> PyramidCache::lookup(const QString &path)
+{
+    const QFileInfo fileInfo(path);
+    if (!fileInfo.isFile())
+        return QSharedPointer<const PyramidFile>();
+
+    const QString cachePath = cacheFilePath(fileInfo);
+    if (!QFileInfo::exists(cachePath))
+        return QSharedPointer<const PyramidFile>();
+
+    QSharedPointer<const PyramidFile> pyramid = PyramidFile::open(cachePath);
+    if (!pyramid) {
+        // Truncated or from an older version: make room for a fresh one
+        QFile::remove(cachePath);
+        return pyramid;
+    }
+
+    // Mark as recently used for eviction
+    QFile touch(cachePath);
+    if (touch.open(QIODevice::ReadWrite))
+        touch.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return pyramid;
+}
+
+void PyramidCache::store(const QString &path, const QImage &image)
+{
+    if (m_diskBudget <= 0 || image.isNull()
+            || qMax(image.width(), image.height()) < MinCachedSide
+            || m_pendingWrites.contains(path)) {
+        return;
+    }
+
+    const QFileInfo fileInfo(path);
+    const QString cachePath = cacheFilePath(fileInfo);
+    if (!fileInfo.isFile() || QFileInfo::exists(cachePath))
+        return;
+
+    m_pendingWrites.insert(path);
+    const qint64 budget = m_diskBudget;
+
+    auto *watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher, path]() {
+        watcher->deleteLater();
+        m_pendingWrites.remove(path);
+    });
+
+    // The QImage is shared, not copied; the model may drop it meanwhile
+    watcher->setFuture(QtConcurrent::run(m_writePool, [cachePath, image, budget]() {
+        const QString cacheDir = QFileInfo(cachePath).absolutePath();
+        if (!QDir().mkpath(cacheDir))
+            return;
+        if (PyramidFile::write(cachePath, image))
+            evict(cacheDir, budget);
+    }));
+}
+
+void PyramidCache::evict(const QString &cacheDir, qint64 budget)
+{
+    // Newest first: everything past the budget is the least recently used
+    const QFileInfoList files = QDir(cacheDir).entryInfoList(QStringList() << "*.rlpyr",
+                                                             QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for (const QFileInfo &file : files) {
+        total += file.size();
+        if (total > budget && !QFile::remove(file.absoluteFilePath()))
+            qWarning() << "Pyramid cache: cannot evict" << file.absoluteFilePath();
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef PYRAMIDCACHE_H
+#define PYRAMIDCACHE_H
+
+#include <QObject>
+#include <QFileInfo>
+#include <QImage>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+
+class PyramidFile;
+class QThreadPool;
+
+/**
+ * @brief Persistent cache of decoded image pyramids for revisited images.
+ *
+ * Images that are expensive to decode (TIFF and other formats without scaled
+ * or clipped decoding) are written once as a PyramidFile under
+ * <image dir>/.rigidlabeler_cache/pyramids/, keyed by absolute path,
+ * modification time and file size. A later visit maps that file instead of
+ * decompressing the source again, and only the tiles actually painted are
+ * paged in.
+ *
+ * Each directory's pyramid folder is bounded by the disk budget; the least
+ * recently used files are evicted after every write. lookup() refreshes a
+ * file's timestamp, which serves as its last-use time.
+ */
+class PyramidCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Smaller images decode faster than a pyramid is written and paged in
+    static constexpr int MinCachedSide = 2048;
+
+    explicit PyramidCache(QObject *parent = nullptr);
+    ~PyramidCache();
+
+    void setDiskBudget(qint64 bytes);
+    qint64 diskBudget() const { return m_diskBudget; }
+
+    // Thread-safe; null if there is no valid pyramid for the file's current version
+    static QSharedPointer<const PyramidFile> lookup(const QString &path);
+
+    // Writes the pyramid of a fully decoded image in the background
+    // (no-op for small images and files already cached or being written)
+    void store(const QString &path, const QImage &image);
+
+    static QString cacheFilePath(const QFileInfo &fileInfo);
+
+private:
+    static void evict(const QString &cacheDir, qint64 budget);
+
+    QThreadPool *m_writePool;
+    QSet<QString> m_pendingWrites;
+    qint64 m_diskBudget;
+};
+
+#endif // PYRAMIDCACHE_H
@@ -0,0 +1,293 @@
+#include "PyramidFile.h"
+#include <QSaveFile>
+#include <QDebug>
+#include <cstring>
+
+namespace {
+
+constexpr char Magic[8] = {'R', 'L', 'P', 'Y', 'R', 'A', 'M', 'D'};
+constexpr quint32 Version = 1;
+constexpr quint32 ByteOrderMark = 0x01020304;
+constexpr quint64 TileAlignment = 4096;
+constexpr int MaxLevels = 32;
+
+struct FileHeader {
+    char magic[8];
+    quint32 version;
+    quint32 byteOrder;
+    quint32 tileSize;
+    quint32 levelCount;
+};
+
+struct LevelEntry {
+    quint32 width;
+    quint32 height;
+    quint32 format;      // QImage::Format
+    quint32 firstTile;
+};
+
+quint64 alignUp(quint64 value, quint64 alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+QSize halfSize(const QSize &size)
+{
+    return QSize(qMax(1, (size.width() + 1) / 2), qMax(1, (size.height() + 1) / 2));
+}
+
+int tileCount(int length)
+{
+    return (length + PyramidFile::TileSize - 1) / PyramidFile::TileSize;
+}
+
+// Formats whose pixels can be stored as plain bytes (no colour table, whole bytes)
+bool isStorable(QImage::Format format)
+{
+    if (format <= QImage::Format_Invalid || format >= QImage::NImageFormats)
+        return false;
+    if (format == QImage::Format_Indexed8)
+        return false;
+    const int bits = QImage::toPixelFormat(format).bitsPerPixel();
+    return bits >= 8 && bits % 8 == 0;
+}
+
+void releaseMapping(void *info)
+{
+    delete static_cast<QSharedPointer<const PyramidFile> *>(info);
+}
+
+} // namespace
+
+PyramidFile::~PyramidFile()
+{
+    if (m_data)
+        m_file.unmap(const_cast<uchar *>(m_data));
+}
+
+qsizetype PyramidFile::bytesPerLine(int width, QImage::Format format)
+{
+    // Same 32-bit scanline alignment as QImage
+    const qsizetype bits = qsizetype(width) * QImage::toPixelFormat(format).bitsPerPixel();
+    return ((bits + 31) >> 5) << 2;
+}
+
+QSize PyramidFile::levelSize(int level) const
+{
+    return (level >= 0 && level < m_levels.size()) ? m_levels.at(level).size : QSize();
+}
+
+QImage::Format PyramidFile::levelFormat(int level) const
+{
+    return (level >= 0 && level < m_levels.size()) ? m_levels.at(level).format : QImage::Format_Invalid;
+}
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+QSharedPointer<const PyramidFile> PyramidFile::open(const QString &filePath)
+{
+    QSharedPointer<PyramidFile> pyramid(new PyramidFile);
+    pyramid->m_file.setFileName(filePath);
+    if (!pyramid->m_file.open(QIODevice::ReadOnly))
+        return QSharedPointer<const PyramidFile>();
+
+    pyramid->m_size = pyramid->m_file.size();
+    if (pyramid->m_size < qint64(sizeof(FileHeader)))
+        return QSharedPointer<const PyramidFile>();
+
+    pyramid->m_data = pyramid->m_file.map(0, pyramid->m_size);
+    if (!pyramid->m_data) {
+        qWarning() << "Pyramid cache: cannot map" << filePath << pyramid->m_file.errorString();
+        return QSharedPointer<const PyramidFile>();
+    }
+
+    FileHeader header;
+    std::memcpy(&header, pyramid->m_data, sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version
+            || header.byteOrder != ByteOrderMark || header.tileSize != quint32(TileSize)
+            || header.levelCount == 0 || header.levelCount > quint32(MaxLevels)) {
+        return QSharedPointer<const PyramidFile>();
+    }
+
+    const quint64 levelTableOffset = sizeof(FileHeader);
+    const quint64 tileTableOffset = levelTableOffset + header.levelCount * sizeof(LevelEntry);
+    if (tileTableOffset > quint64(pyramid->m_size))
+        return QSharedPointer<const PyramidFile>();
+
+    int totalTiles = 0;
+    for (quint32 i = 0; i < header.levelCount; ++i) {
+        LevelEntry entry;
+        std::memcpy(&entry, pyramid->m_data + levelTableOffset + i * sizeof(LevelEntry), sizeof(entry));
+        const QImage::Format format = QImage::Format(entry.format);
+        if (entry.width == 0 || entry.height == 0 || entry.width > 1u << 20 || entry.height > 1u << 20
+                || !isStorable(format) || entry.firstTile != quint32(totalTiles)) {
+            return QSharedPointer<const PyramidFile>();
+        }
+
+        Level level;
+        level.size = QSize(int(entry.width), int(entry.height));
+        level.format = format;
+        level.columns = tileCount(level.size.width());
+        level.rows = tileCount(level.size.height());
+        level.firstTile = totalTiles;
+        totalTiles += level.columns * level.rows;
+        pyramid->m_levels.append(level);
+    }
+
+    if (tileTableOffset + quint64(totalTiles) * sizeof(quint64) > quint64(pyramid->m_size))
+        return QSharedPointer<const PyramidFile>();
+
+    pyramid->m_tileOffsets.resize(totalTiles);
+    std::memcpy(pyramid->m_tileOffsets.data(), pyramid->m_data + tileTableOffset,
+                size_t(totalTiles) * sizeof(quint64));
+
+    // Every tile must lie inside the file: a truncated write is a cache miss
+    for (const Level &level : std::as_const(pyramid->m_levels)) {
+        for (int ty = 0; ty < level.rows; ++ty) {
+            for (int tx = 0; tx < level.columns; ++tx) {
+                const int w = qMin(TileSize, level.size.width() - tx * TileSize);
+                const int h = qMin(TileSize, level.size.height() - ty * TileSize);
+                const quint64 offset = pyramid->m_tileOffsets.at(level.firstTile + ty * level.columns + tx);
+                const quint64 bytes = quint64(bytesPerLine(w, level.format)) * h;
+                if (offset % TileAlignment != 0 || offset + bytes > quint64(pyramid->m_size))
+                    return QSharedPointer<const PyramidFile>();
+            }
+        }
+    }
+
+    return pyramid;
+}
+
+QImage PyramidFile::tile(int level, int tx, int ty) const
+{
+    if (level < 0 || level >= m_levels.size())
+        return QImage();
+    const Level &lv = m_levels.at(level);
+    if (tx < 0 || ty < 0 || tx >= lv.columns || ty >= lv.rows)
+        return QImage();
+
+    const int w = qMin(TileSize, lv.size.width() - tx * TileSize);
+    const int h = qMin(TileSize, lv.size.height() - ty * TileSize);
+    const uchar *data = m_data + m_tileOffsets.at(lv.firstTile + ty * lv.columns + tx);
+
+    // Read-only view into the mapping; each image holds a reference so the
+    // file stays mapped for as long as any tile (or pixmap sharing it) lives
+    return QImage(data, w, h, bytesPerLine(w, lv.format), lv.format,
+                  releaseMapping, new QSharedPointer<const PyramidFile>(sharedFromThis()));
+}
+
+QImage PyramidFile::levelImage(int level) const
+{
+    if (level < 0 || level >= m_levels.size())
+        return QImage();
+    const Level &lv = m_levels.at(level);
+
+    QImage image(lv.size, lv.format);
+    if (image.isNull())
+        return QImage();
+
+    const int bytesPerPixel = QImage::toPixelFormat(lv.format).bitsPerPixel() / 8;
+    for (int ty = 0; ty < lv.rows; ++ty) {
+        for (int tx = 0; tx < lv.columns; ++tx) {
+            const int w = qMin(TileSize, lv.size.width() - tx * TileSize);
+            const int h = qMin(TileSize, lv.size.height() - ty * TileSize);
+            const qsizetype tileBpl = bytesPerLine(w, lv.format);
+            const uchar *src = m_data + m_tileOffsets.at(lv.firstTile + ty * lv.columns + tx);
+            for (int y = 0; y < h; ++y) {
+                std::memcpy(image.scanLine(ty * TileSize + y) + qsizetype(tx) * TileSize * bytesPerPixel,
+                            src + y * tileBpl, size_t(w) * bytesPerPixel);
+            }
+        }
+    }
+    return image;
+}
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+bool PyramidFile::write(const QString &filePath, const QImage &image)
+{
+    if (image.isNull())
+        return false;
+
+    QImage base = image;
+    if (!isStorable(base.format()))
+        base = base.convertToFormat(base.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                           : QImage::Format_RGB32);
+
+    // Same halving as the view's tile pyramid
+    QVector<QImage> levels{base};
+    while (levels.last().width() > TileSize || levels.last().height() > TileSize) {
+        const QImage &previous = levels.last();
+        QImage next = previous.scaled(halfSize(previous.size()), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        if (!isStorable(next.format()))
+            next = next.convertToFormat(base.format());
+        levels.append(next);
+    }
+    if (levels.size() > MaxLevels)
+        return false;
+
+    // Lay out the tiles first so the tables can be written up front
+    QVector<LevelEntry> entries;
+    QVector<quint64> tileOffsets;
+    const quint64 tileTableOffset = sizeof(FileHeader) + levels.size() * sizeof(LevelEntry);
+    int totalTiles = 0;
+    for (const QImage &level : std::as_const(levels))
+        totalTiles += tileCount(level.width()) * tileCount(level.height());
+
+    quint64 offset = alignUp(tileTableOffset + quint64(totalTiles) * sizeof(quint64), TileAlignment);
+    for (const QImage &level : std::as_const(levels)) {
+        entries.append(LevelEntry{quint32(level.width()), quint32(level.height()),
+                                  quint32(level.format()), quint32(tileOffsets.size())});
+        for (int ty = 0; ty < tileCount(level.height()); ++ty) {
+            for (int tx = 0; tx < tileCount(level.width()); ++tx) {
+                const int w = qMin(TileSize, level.width() - tx * TileSize);
+                const int h = qMin(TileSize, level.height() - ty * TileSize);
+                tileOffsets.append(offset);
+                offset = alignUp(offset + quint64(bytesPerLine(w, level.format())) * h, TileAlignment);
+            }
+        }
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.byteOrder = ByteOrderMark;
+    header.tileSize = quint32(TileSize);
+    header.levelCount = quint32(levels.size());
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    bool ok = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header))
+        && file.write(reinterpret_cast<const char *>(entries.constData()), entries.size() * sizeof(LevelEntry))
+               == qint64(entries.size() * sizeof(LevelEntry))
+        && file.write(reinterpret_cast<const char *>(tileOffsets.constData()), tileOffsets.size() * sizeof(quint64))
+               == qint64(tileOffsets.size() * sizeof(quint64));
+
+    int tileIndex = 0;
+    for (const QImage &level : std::as_const(levels)) {
+        for (int ty = 0; ok && ty < tileCount(level.height()); ++ty) {
+            for (int tx = 0; ok && tx < tileCount(level.width()); ++tx) {
+                // copy() gives exactly the stored layout: 32-bit aligned scanlines
+                const QImage tile = level.copy(tx * TileSize, ty * TileSize,
+                                               qMin(TileSize, level.width() - tx * TileSize),
+                                               qMin(TileSize, level.height() - ty * TileSize));
+                ok = file.seek(qint64(tileOffsets.at(tileIndex++)))
+                    && file.write(reinterpret_cast<const char *>(tile.constBits()), tile.sizeInBytes())
+                           == tile.sizeInBytes();
+            }
+        }
+    }
+
+    if (!ok) {
+        qWarning() << "Pyramid cache: write failed" << filePath << file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
@@ -0,0 +1,69 @@
+#ifndef PYRAMIDFILE_H
+#define PYRAMIDFILE_H
+
+#include <QEnableSharedFromThis>
+#include <QFile>
+#include <QImage>
+#include <QSharedPointer>
+#include <QSize>
+#include <QVector>
+
+/**
+ * @brief Memory-mapped, decoded image pyramid stored on disk.
+ *
+ * Holds every power-of-two level of an image (level 0 = full resolution,
+ * each next level half the size, down to the first that fits a single tile),
+ * split into TileSize x TileSize tiles. Each tile is stored as raw QImage
+ * scanlines in the level's native format and starts on a page boundary, so
+ * reading a tile only faults in the pages of that tile.
+ *
+ * File layout (native byte order, guarded by a byte-order mark):
+ *   Header | LevelEntry[levelCount] | quint64 tileOffset[total tiles] | tiles
+ *
+ * Opened files are mapped read-only and shared: tile() returns QImages that
+ * point into the mapping and keep it alive. All reads are thread-safe.
+ */
+class PyramidFile : public QEnableSharedFromThis<PyramidFile>
+{
+public:
+    static constexpr int TileSize = 512;
+
+    // Maps an existing file; null if missing, truncated or of another version
+    static QSharedPointer<const PyramidFile> open(const QString &filePath);
+
+    // Builds all levels of image and writes them atomically to filePath
+    static bool write(const QString &filePath, const QImage &image);
+
+    ~PyramidFile();
+
+    QSize sourceSize() const { return levelSize(0); }
+    int levelCount() const { return int(m_levels.size()); }
+    QSize levelSize(int level) const;
+    QImage::Format levelFormat(int level) const;
+
+    // Tile of a level, pointing into the mapping (no copy)
+    QImage tile(int level, int tx, int ty) const;
+    // Whole level assembled into one image (copies; meant for small levels)
+    QImage levelImage(int level) const;
+
+private:
+    struct Level {
+        QSize size;
+        QImage::Format format;
+        int columns;
+        int rows;
+        int firstTile;   // Index into m_tileOffsets
+    };
+
+    PyramidFile() = default;
+
+    static qsizetype bytesPerLine(int width, QImage::Format format);
+
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    QVector<Level> m_levels;
+    QVector<quint64> m_tileOffsets;
+};
+
+#endif // PYRAMIDFILE_H
@@ -0,0 +1,122 @@
+#include "ThumbnailCache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFutureWatcher>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+
+ThumbnailCache::ThumbnailCache(QObject *parent)
+    : QObject(parent)
+    , m_pool(new QThreadPool(this))
+{
+    // Leave cores for image decoding; thumbnails are a background nicety
+    m_pool->setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+    m_memory.setMaxCost(64 * 1024);   // 64 MiB
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+    m_queue.clear();
+    m_pool->waitForDone();
+}
+
+QPixmap ThumbnailCache::thumbnail(const QString &path)
+{
+    if (QPixmap *cached = m_memory.object(path))
+        return *cached;
+
+    if (m_failed.contains(path) || m_running.contains(path))
+        return QPixmap();
+
+    // Re-requesting moves the path to the front of the line
+    m_queue.removeOne(path);
+    m_queue.append(path);
+    while (m_queue.size() > MaxQueued)
+        m_queue.removeFirst();
+
+    schedule();
+    return QPixmap();
+}
+
+void ThumbnailCache::schedule()
+{
+    while (m_running.size() < m_pool->maxThreadCount() && !m_queue.isEmpty()) {
+        const QString path = m_queue.takeLast();
+        m_running.insert(path);
+
+        auto *watcher = new QFutureWatcher<QImage>(this);
+        connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, path]() {
+            watcher->deleteLater();
+            onThumbnailProduced(path, watcher->result());
+        });
+        watcher->setFuture(QtConcurrent::run(m_pool, [path]() -> QImage {
+            return produceThumbnail(path);
+        }));
+    }
+}
+
+void ThumbnailCache::onThumbnailProduced(const QString &path, const QImage &image)
+{
+    m_running.remove(path);
+
+    if (image.isNull()) {
+        m_failed.insert(path);
+    } else {
+        QPixmap *pixmap = new QPixmap(QPixmap::fromImage(image));
+        m_memory.insert(path, pixmap, qMax<qsizetype>(1, qsizetype(image.sizeInBytes() / 1024)));
+        emit thumbnailReady(path);
+    }
+
+    schedule();
+}
+
+QString ThumbnailCache::diskCachePath(const QFileInfo &fileInfo)
+{
+    // A changed file gets a new key, so stale thumbnails are simply never read
+    const QByteArray key = fileInfo.absoluteFilePath().toUtf8() + '|'
+        + QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch()) + '|'
+        + QByteArray::number(fileInfo.size());
+    const QString name = QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex());
+    return fileInfo.absolutePath() + "/.rigidlabeler_cache/thumbnails/" + name + ".jpg";
+}
+
+QImage ThumbnailCache::produceThumbnail(const QString &path)
+{
+    QFileInfo fileInfo(path);
+    if (!fileInfo.isFile())
+        return QImage();
+
+    const QString cachePath = diskCachePath(fileInfo);
+    QImage image;
+    if (QFileInfo::exists(cachePath) && image.load(cachePath, "JPG"))
+        return image;
+
+    // Let the decoder downscale (JPEG does this during the DCT) instead of
+    // decoding the full image first
+    QImageReader reader(path);
+    const QSize sourceSize = reader.size();
+    if (sourceSize.isValid())
+        reader.setScaledSize(sourceSize.scaled(ThumbnailSize, ThumbnailSize, Qt::KeepAspectRatio)
+                                 .expandedTo(QSize(1, 1)));
+    image = reader.read();
+    if (image.isNull()) {
+        qWarning() << "Thumbnail decode failed:" << path << reader.errorString();
+        return QImage();
+    }
+    if (image.width() > ThumbnailSize || image.height() > ThumbnailSize)
+        image = image.scaled(ThumbnailSize, ThumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    image = image.convertToFormat(QImage::Format_RGB32);
+
+    // Best effort: read-only folders just don't get a disk cache
+    QDir().mkpath(QFileInfo(cachePath).absolutePath());
+    QSaveFile file(cachePath);
+    if (file.open(QIODevice::WriteOnly) && image.save(&file, "JPG", 85))
+        file.commit();
+
+    return image;
+}
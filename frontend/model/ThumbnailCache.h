@@ -0,0 +1,61 @@
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QFileInfo>
+#include <QImage>
+#include <QPixmap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+class QThreadPool;
+
+/**
+ * @brief Thumbnail provider with a bounded worker pool and a persistent disk cache.
+ *
+ * thumbnail() never decodes on the calling thread: it returns the in-memory
+ * thumbnail if present, and otherwise queues the file and returns a null
+ * pixmap; thumbnailReady() fires once it is available.
+ *
+ * Requests are served newest first, so the items currently scrolled into view
+ * win over ones requested earlier, and the queue is capped so a fast scroll
+ * through a large folder does not pile up work. Produced thumbnails are
+ * written to <image dir>/.rigidlabeler_cache/thumbnails/, keyed by absolute
+ * path, modification time and file size, and are reused on later runs.
+ *
+ * All public methods must be called from the GUI thread.
+ */
+class ThumbnailCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int ThumbnailSize = 128;   // Longest side in pixels
+    static constexpr int MaxQueued = 256;
+
+    explicit ThumbnailCache(QObject *parent = nullptr);
+    ~ThumbnailCache();
+
+    QPixmap thumbnail(const QString &path);
+
+    // Location of the on-disk thumbnail for a file in its current version
+    static QString diskCachePath(const QFileInfo &fileInfo);
+
+signals:
+    void thumbnailReady(const QString &path);
+
+private:
+    void schedule();
+    void onThumbnailProduced(const QString &path, const QImage &image);
+    static QImage produceThumbnail(const QString &path);
+
+    QThreadPool *m_pool;
+    QCache<QString, QPixmap> m_memory;   // Cost unit: KiB
+    QStringList m_queue;                 // Newest request last, served first
+    QSet<QString> m_running;
+    QSet<QString> m_failed;              // Not retried until the cache is recreated
+};
+
+#endif // THUMBNAILCACHE_H
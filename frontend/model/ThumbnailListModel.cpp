@@ -0,0 +1,65 @@
+#include "ThumbnailListModel.h"
+#include "ThumbnailCache.h"
+
+ThumbnailListModel::ThumbnailListModel(ThumbnailCache *cache, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_cache(cache)
+    , m_placeholder(ThumbnailCache::ThumbnailSize, ThumbnailCache::ThumbnailSize)
+{
+    m_placeholder.fill(QColor(60, 60, 60));
+    connect(m_cache, &ThumbnailCache::thumbnailReady, this, &ThumbnailListModel::onThumbnailReady);
+}
+
+void ThumbnailListModel::setFiles(const QString &dir, const QStringList &files)
+{
+    if (dir == m_dir && files == m_files)
+        return;
+
+    beginResetModel();
+    m_dir = dir;
+    m_files = files;
+    m_rowOfPath.clear();
+    m_rowOfPath.reserve(m_files.size());
+    for (int row = 0; row < m_files.size(); ++row)
+        m_rowOfPath.insert(filePath(row), row);
+    endResetModel();
+}
+
+QString ThumbnailListModel::filePath(int row) const
+{
+    if (row < 0 || row >= m_files.size())
+        return QString();
+    return m_dir + "/" + m_files[row];
+}
+
+int ThumbnailListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(m_files.size());
+}
+
+QVariant ThumbnailListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_files.size())
+        return QVariant();
+
+    switch (role) {
+    case Qt::DecorationRole: {
+        const QPixmap thumbnail = m_cache->thumbnail(filePath(index.row()));
+        return thumbnail.isNull() ? m_placeholder : thumbnail;
+    }
+    case Qt::ToolTipRole:
+        return tr("%1 (%2/%3)").arg(m_files[index.row()]).arg(index.row() + 1).arg(m_files.size());
+    default:
+        return QVariant();
+    }
+}
+
+void ThumbnailListModel::onThumbnailReady(const QString &path)
+{
+    const auto it = m_rowOfPath.constFind(path);
+    if (it == m_rowOfPath.constEnd())
+        return;
+
+    const QModelIndex idx = index(it.value());
+    emit dataChanged(idx, idx, {Qt::DecorationRole});
+}
@@ -0,0 +1,41 @@
+#ifndef THUMBNAILLISTMODEL_H
+#define THUMBNAILLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QPixmap>
+#include <QStringList>
+
+class ThumbnailCache;
+
+/**
+ * @brief List model over the image files of one directory, decorated with thumbnails.
+ *
+ * Thumbnails are only requested from the ThumbnailCache when a view asks for
+ * an item's decoration, so only the rows actually painted cost any decoding.
+ * Until a thumbnail is ready a placeholder is returned.
+ */
+class ThumbnailListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit ThumbnailListModel(ThumbnailCache *cache, QObject *parent = nullptr);
+
+    void setFiles(const QString &dir, const QStringList &files);
+    QString filePath(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    void onThumbnailReady(const QString &path);
+
+    ThumbnailCache *m_cache;
+    QString m_dir;
+    QStringList m_files;
+    QHash<QString, int> m_rowOfPath;
+    QPixmap m_placeholder;
+};
+
+#endif // THUMBNAILLISTMODEL_H
@@ -1,5 +1,7 @@
 #include "TiePointModel.h"
 #include <QColor>
+#include <QtNumeric>
+#include <algorithm>
 
 TiePointModel::TiePointModel(QObject *parent)
     : QAbstractTableModel(parent)
@@ -15,7 +17,7 @@ int TiePointModel::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid())
         return 0;
-    return m_pairs.count();
+    return m_pairIndices.size();
 }
 
 int TiePointModel::columnCount(const QModelIndex &parent) const
@@ -27,39 +29,23 @@ int TiePointModel::columnCount(const QModelIndex &parent) const
 
 QVariant TiePointModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() >= m_pairs.count())
+    if (!index.isValid() || index.row() >= m_pairIndices.size())
         return QVariant();
 
-    const TiePointPair &pair = m_pairs.at(index.row());
+    const int row = index.row();
+    const bool hasFixed = m_flags.at(row) & HasFixed;
+    const bool hasMoving = m_flags.at(row) & HasMoving;
 
     if (role == Qt::DisplayRole || role == Qt::EditRole) {
         switch (index.column()) {
         case ColIndex:
-            return index.row() + 1;  // 1-based index
+            return row + 1;  // 1-based index
         case ColFixedX:
-            if (pair.hasFixed()) {
-                QPointF displayPos = toDisplayCoord(*pair.fixed, true);
-                return QString::number(displayPos.x(), 'f', 2);
-            }
-            return QString("-");
         case ColFixedY:
-            if (pair.hasFixed()) {
-                QPointF displayPos = toDisplayCoord(*pair.fixed, true);
-                return QString::number(displayPos.y(), 'f', 2);
-            }
-            return QString("-");
         case ColMovingX:
-            if (pair.hasMoving()) {
-                QPointF displayPos = toDisplayCoord(*pair.moving, false);
-                return QString::number(displayPos.x(), 'f', 2);
-            }
-            return QString("-");
         case ColMovingY:
-            if (pair.hasMoving()) {
-                QPointF displayPos = toDisplayCoord(*pair.moving, false);
-                return QString::number(displayPos.y(), 'f', 2);
-            }
-            return QString("-");
+        case ColResidual:
+            return displayText(row, index.column());
         }
     }
 
@@ -69,10 +55,10 @@ QVariant TiePointModel::data(const QModelIndex &index, int role) const
     
     // Gray out incomplete entries
     if (role == Qt::ForegroundRole) {
-        if ((index.column() == ColFixedX || index.column() == ColFixedY) && !pair.hasFixed()) {
+        if ((index.column() == ColFixedX || index.column() == ColFixedY) && !hasFixed) {
             return QColor(Qt::gray);
         }
-        if ((index.column() == ColMovingX || index.column() == ColMovingY) && !pair.hasMoving()) {
+        if ((index.column() == ColMovingX || index.column() == ColMovingY) && !hasMoving) {
             return QColor(Qt::gray);
         }
     }
@@ -97,6 +83,8 @@ QVariant TiePointModel::headerData(int section, Qt::Orientation orientation, int
             return tr("Moving X");
         case ColMovingY:
             return tr("Moving Y");
+        case ColResidual:
+            return tr("Residual");
         }
     }
 
@@ -111,12 +99,12 @@ Qt::ItemFlags TiePointModel::flags(const QModelIndex &index) const
     Qt::ItemFlags flags = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
     
     // Allow editing of coordinate columns (not index) only if the point exists
-    if (index.column() != ColIndex && index.row() < m_pairs.count()) {
-        const TiePointPair &pair = m_pairs.at(index.row());
-        if ((index.column() == ColFixedX || index.column() == ColFixedY) && pair.hasFixed()) {
+    if (index.column() != ColIndex && index.row() < m_pairIndices.size()) {
+        const quint8 pointFlags = m_flags.at(index.row());
+        if ((index.column() == ColFixedX || index.column() == ColFixedY) && (pointFlags & HasFixed)) {
             flags |= Qt::ItemIsEditable;
         }
-        if ((index.column() == ColMovingX || index.column() == ColMovingY) && pair.hasMoving()) {
+        if ((index.column() == ColMovingX || index.column() == ColMovingY) && (pointFlags & HasMoving)) {
             flags |= Qt::ItemIsEditable;
         }
     }
@@ -129,7 +117,7 @@ bool TiePointModel::setData(const QModelIndex &index, const QVariant &value, int
     if (!index.isValid() || role != Qt::EditRole)
         return false;
 
-    if (index.row() >= m_pairs.count())
+    if (index.row() >= m_pairIndices.size())
         return false;
 
     bool ok;
@@ -137,7 +125,7 @@ bool TiePointModel::setData(const QModelIndex &index, const QVariant &value, int
     if (!ok)
         return false;
 
-    int pairIndex = m_pairs.at(index.row()).index;
+    const int row = index.row();
 
     // Convert display coordinate back to pixel coordinate
     // The user enters display coordinates, we need to store pixel coordinates
@@ -152,34 +140,34 @@ bool TiePointModel::setData(const QModelIndex &index, const QVariant &value, int
     switch (index.column()) {
     case ColFixedX:
     case ColFixedY: {
-        int idx = findFixedPointIndex(pairIndex);
-        if (idx >= 0) {
-            double pixelVal = displayToPixel(val, index.column() == ColFixedX, true);
-            if (index.column() == ColFixedX)
-                m_fixedPoints[idx].position.setX(pixelVal);
-            else
-                m_fixedPoints[idx].position.setY(pixelVal);
-        }
+        if (!(m_flags.at(row) & HasFixed))
+            return false;
+        double pixelVal = displayToPixel(val, index.column() == ColFixedX, true);
+        if (index.column() == ColFixedX)
+            m_fixedPoints[row].setX(pixelVal);
+        else
+            m_fixedPoints[row].setY(pixelVal);
         break;
     }
     case ColMovingX:
     case ColMovingY: {
-        int idx = findMovingPointIndex(pairIndex);
-        if (idx >= 0) {
-            double pixelVal = displayToPixel(val, index.column() == ColMovingX, false);
-            if (index.column() == ColMovingX)
-                m_movingPoints[idx].position.setX(pixelVal);
-            else
-                m_movingPoints[idx].position.setY(pixelVal);
-        }
+        if (!(m_flags.at(row) & HasMoving))
+            return false;
+        double pixelVal = displayToPixel(val, index.column() == ColMovingX, false);
+        if (index.column() == ColMovingX)
+            m_movingPoints[row].setX(pixelVal);
+        else
+            m_movingPoints[row].setY(pixelVal);
         break;
     }
     default:
         return false;
     }
 
-    rebuildPairs();
-    emit dataChanged(index, index, {role});
+    // Only the edited cell changed
+    m_displayText[TextColumns * row + index.column() - ColFixedX] = QString();
+    m_packedDirty = true;
+    emit dataChanged(index, index);
     return true;
 }
 
@@ -189,41 +177,21 @@ bool TiePointModel::setData(const QModelIndex &index, const QVariant &value, int
 
 int TiePointModel::addFixedPointDirect(const QPointF &point)
 {
-    // Find a pair that needs a fixed point (has moving but no fixed)
-    int pairIndex = -1;
-    
-    for (const TiePointPair &pair : m_pairs) {
-        if (pair.hasMoving() && !pair.hasFixed()) {
-            pairIndex = pair.index;
-            break;
-        }
-    }
-    
-    // If no incomplete pair found, create new pair index
-    if (pairIndex < 0) {
-        pairIndex = getNextPairIndex();
-    }
-    
+    // Lowest pair that needs a fixed point (has moving but no fixed),
+    // otherwise a new pair
+    const int pairIndex = m_awaitingFixed.empty() ? getNextPairIndex() : *m_awaitingFixed.begin();
     return addFixedPointDirect(pairIndex, point);
 }
 
 int TiePointModel::addFixedPointDirect(int pairIndex, const QPointF &point)
 {
-    // Add to fixed points
-    m_fixedPoints.append(PointEntry(pairIndex, point));
+    const int row = setPoints(pairIndex, HasFixed, point, QPointF());
     
     // Set active stack
     m_activeStack = ActiveStack::Fixed;
     
-    // Rebuild pairs and update view
-    rebuildPairs();
-    
-    // Check if pair is now complete
-    for (const TiePointPair &pair : m_pairs) {
-        if (pair.index == pairIndex && pair.isComplete()) {
-            emit pairCompleted(pairIndex);
-            break;
-        }
+    if (m_flags.at(row) == HasBoth) {
+        emit pairCompleted(pairIndex);
     }
     
     emit pointAdded(pairIndex, true);
@@ -233,42 +201,21 @@ int TiePointModel::addFixedPointDirect(int pairIndex, const QPointF &point)
 
 int TiePointModel::addMovingPointDirect(const QPointF &point)
 {
-    // Find the pair index that needs a moving point
-    int pairIndex = -1;
-    
-    // Look for a pair that has fixed but no moving
-    for (const TiePointPair &pair : m_pairs) {
-        if (pair.hasFixed() && !pair.hasMoving()) {
-            pairIndex = pair.index;
-            break;
-        }
-    }
-    
-    // If no incomplete pair found, create new pair index
-    if (pairIndex < 0) {
-        pairIndex = getNextPairIndex();
-    }
-    
+    // Lowest pair that needs a moving point (has fixed but no moving),
+    // otherwise a new pair
+    const int pairIndex = m_awaitingMoving.empty() ? getNextPairIndex() : *m_awaitingMoving.begin();
     return addMovingPointDirect(pairIndex, point);
 }
 
 int TiePointModel::addMovingPointDirect(int pairIndex, const QPointF &point)
 {
-    // Add to moving points
-    m_movingPoints.append(PointEntry(pairIndex, point));
+    const int row = setPoints(pairIndex, HasMoving, QPointF(), point);
     
     // Set active stack
     m_activeStack = ActiveStack::Moving;
     
-    // Rebuild pairs and update view
-    rebuildPairs();
-    
-    // Check if pair is now complete
-    for (const TiePointPair &pair : m_pairs) {
-        if (pair.index == pairIndex && pair.isComplete()) {
-            emit pairCompleted(pairIndex);
-            break;
-        }
+    if (m_flags.at(row) == HasBoth) {
+        emit pairCompleted(pairIndex);
     }
     
     emit pointAdded(pairIndex, false);
@@ -278,29 +225,235 @@ int TiePointModel::addMovingPointDirect(int pairIndex, const QPointF &point)
 
 void TiePointModel::removePointDirect(int pairIndex, bool isFixed)
 {
-    if (isFixed) {
-        for (int i = m_fixedPoints.size() - 1; i >= 0; --i) {
-            if (m_fixedPoints[i].pairIndex == pairIndex) {
-                m_fixedPoints.removeAt(i);
-                break;
-            }
+    clearPoints(pairIndex, isFixed ? HasFixed : HasMoving);
+    
+    // Update active stack
+    m_activeStack = ActiveStack::None;
+    
+    emit pointRemoved(pairIndex, isFixed);
+}
+
+int TiePointModel::appendPairs(const QList<TiePointPair> &pairs)
+{
+    int count = 0;
+    for (const TiePointPair &pair : pairs) {
+        if (pair.hasFixed() || pair.hasMoving())
+            ++count;
+    }
+    if (count == 0)
+        return 0;
+    
+    // Into an empty model this is a load: one reset, views rebuild once
+    const bool reset = m_pairIndices.isEmpty();
+    const int first = m_pairIndices.size();
+    if (reset)
+        beginResetModel();
+    else
+        beginInsertRows(QModelIndex(), first, first + count - 1);
+    
+    m_pairIndices.reserve(first + count);
+    m_fixedPoints.reserve(first + count);
+    m_movingPoints.reserve(first + count);
+    m_flags.reserve(first + count);
+    
+    int pairIndex = getNextPairIndex();
+    for (const TiePointPair &pair : pairs) {
+        const quint8 flags = (pair.hasFixed() ? HasFixed : 0) | (pair.hasMoving() ? HasMoving : 0);
+        if (flags == 0)
+            continue;
+        m_pairIndices.append(pairIndex);
+        m_fixedPoints.append(pair.fixed.value_or(QPointF()));
+        m_movingPoints.append(pair.moving.value_or(QPointF()));
+        m_flags.append(flags);
+        account(pairIndex, flags, 1);
+        ++pairIndex;
+    }
+    
+    // New rows start unformatted, with no residual
+    m_displayText.resize(TextColumns * m_pairIndices.size());
+    m_residuals.resize(m_pairIndices.size(), qQNaN());
+    
+    if (reset)
+        endResetModel();
+    else
+        endInsertRows();
+    
+    return count;
+}
+
+TiePointBatch TiePointModel::takePairs(QVector<int> pairIndices)
+{
+    // Rows of the pairs that exist, ascending
+    QVector<int> rows;
+    rows.reserve(pairIndices.size());
+    std::sort(pairIndices.begin(), pairIndices.end());
+    pairIndices.erase(std::unique(pairIndices.begin(), pairIndices.end()), pairIndices.end());
+    for (int pairIndex : pairIndices) {
+        const int row = rowOf(pairIndex);
+        if (row >= 0)
+            rows.append(row);
+    }
+    
+    TiePointBatch batch;
+    if (rows.isEmpty())
+        return batch;
+    
+    batch.pairIndices.reserve(rows.size());
+    batch.fixedPoints.reserve(rows.size());
+    batch.movingPoints.reserve(rows.size());
+    batch.flags.reserve(rows.size());
+    int ranges = 0;
+    for (int i = 0; i < rows.size(); ++i) {
+        const int row = rows.at(i);
+        batch.pairIndices.append(m_pairIndices.at(row));
+        batch.fixedPoints.append(m_fixedPoints.at(row));
+        batch.movingPoints.append(m_movingPoints.at(row));
+        batch.flags.append(m_flags.at(row));
+        account(m_pairIndices.at(row), m_flags.at(row), -1);
+        if (i == 0 || rows.at(i - 1) + 1 != row)
+            ++ranges;
+    }
+    
+    if (ranges <= MaxBatchRanges) {
+        // Back to front, so the rows of earlier ranges stay put
+        int end = rows.size();
+        while (end > 0) {
+            int start = end - 1;
+            while (start > 0 && rows.at(start - 1) + 1 == rows.at(start))
+                --start;
+            const int first = rows.at(start);
+            const int last = rows.at(end - 1);
+            beginRemoveRows(QModelIndex(), first, last);
+            removeRowRange(first, last - first + 1);
+            endRemoveRows();
+            end = start;
         }
     } else {
-        for (int i = m_movingPoints.size() - 1; i >= 0; --i) {
-            if (m_movingPoints[i].pairIndex == pairIndex) {
-                m_movingPoints.removeAt(i);
-                break;
+        // Scattered rows: one compaction pass
+        beginResetModel();
+        int write = 0;
+        int next = 0;
+        for (int row = 0; row < m_pairIndices.size(); ++row) {
+            if (next < rows.size() && rows.at(next) == row) {
+                ++next;
+                continue;
             }
+            m_pairIndices[write] = m_pairIndices.at(row);
+            m_residuals[write] = m_residuals.at(row);
+            m_fixedPoints[write] = m_fixedPoints.at(row);
+            m_movingPoints[write] = m_movingPoints.at(row);
+            m_flags[write] = m_flags.at(row);
+            ++write;
         }
+        m_pairIndices.resize(write);
+        m_fixedPoints.resize(write);
+        m_movingPoints.resize(write);
+        m_flags.resize(write);
+        m_residuals.resize(write);
+        m_displayText.fill(QString(), TextColumns * write);
+        endResetModel();
     }
     
-    // Update active stack
     m_activeStack = ActiveStack::None;
+    return batch;
+}
+
+void TiePointModel::restorePairs(const TiePointBatch &batch)
+{
+    if (batch.isEmpty())
+        return;
     
-    // Rebuild pairs and update view
-    rebuildPairs();
+    // Target row of each entry in the current rows; the batch is ascending,
+    // so entries with the same target row form one contiguous insert
+    QVector<int> targets;
+    targets.reserve(batch.size());
+    int ranges = 0;
+    for (int i = 0; i < batch.size(); ++i) {
+        targets.append(lowerBoundRow(batch.pairIndices.at(i)));
+        if (i == 0 || targets.at(i) != targets.at(i - 1))
+            ++ranges;
+    }
+    
+    if (ranges <= MaxBatchRanges) {
+        // Back to front, so the targets of earlier ranges stay valid
+        int end = batch.size();
+        while (end > 0) {
+            int start = end - 1;
+            while (start > 0 && targets.at(start - 1) == targets.at(end - 1))
+                --start;
+            const int row = targets.at(start);
+            const int count = end - start;
+            beginInsertRows(QModelIndex(), row, row + count - 1);
+            m_pairIndices.insert(row, count, 0);
+            m_fixedPoints.insert(row, count, QPointF());
+            m_movingPoints.insert(row, count, QPointF());
+            m_flags.insert(row, count, 0);
+            m_residuals.insert(row, count, qQNaN());
+            m_displayText.insert(TextColumns * row, TextColumns * count, QString());
+            for (int i = 0; i < count; ++i) {
+                m_pairIndices[row + i] = batch.pairIndices.at(start + i);
+                m_fixedPoints[row + i] = batch.fixedPoints.at(start + i);
+                m_movingPoints[row + i] = batch.movingPoints.at(start + i);
+                m_flags[row + i] = batch.flags.at(start + i);
+                account(batch.pairIndices.at(start + i), batch.flags.at(start + i), 1);
+            }
+            endInsertRows();
+            end = start;
+        }
+    } else {
+        // Scattered rows: one merge pass
+        beginResetModel();
+        const int total = m_pairIndices.size() + batch.size();
+        QVector<int> pairIndices;
+        QVector<QPointF> fixedPoints;
+        QVector<QPointF> movingPoints;
+        QVector<quint8> flags;
+        QVector<float> residuals;
+        pairIndices.reserve(total);
+        fixedPoints.reserve(total);
+        movingPoints.reserve(total);
+        flags.reserve(total);
+        residuals.reserve(total);
+        int row = 0;
+        for (int i = 0; i <= batch.size(); ++i) {
+            const int until = i < batch.size() ? targets.at(i) : m_pairIndices.size();
+            for (; row < until; ++row) {
+                pairIndices.append(m_pairIndices.at(row));
+                fixedPoints.append(m_fixedPoints.at(row));
+                movingPoints.append(m_movingPoints.at(row));
+                flags.append(m_flags.at(row));
+                residuals.append(m_residuals.at(row));
+            }
+            if (i < batch.size()) {
+                pairIndices.append(batch.pairIndices.at(i));
+                fixedPoints.append(batch.fixedPoints.at(i));
+                movingPoints.append(batch.movingPoints.at(i));
+                flags.append(batch.flags.at(i));
+                residuals.append(qQNaN());
+                account(batch.pairIndices.at(i), batch.flags.at(i), 1);
+            }
+        }
+        m_pairIndices.swap(pairIndices);
+        m_fixedPoints.swap(fixedPoints);
+        m_movingPoints.swap(movingPoints);
+        m_flags.swap(flags);
+        m_residuals.swap(residuals);
+        m_displayText.fill(QString(), TextColumns * total);
+        endResetModel();
+    }
     
-    emit pointRemoved(pairIndex, isFixed);
+    m_activeStack = ActiveStack::None;
+}
+
+void TiePointModel::movePointDirect(int pairIndex, bool isFixed, const QPointF &point)
+{
+    const int row = rowOf(pairIndex);
+    if (row < 0)
+        return;
+    if (isFixed)
+        updateFixedPoint(row, point);
+    else
+        updateMovingPoint(row, point);
 }
 
 // ============================================================================
@@ -309,22 +462,34 @@ void TiePointModel::removePointDirect(int pairIndex, bool isFixed)
 
 TiePointPair TiePointModel::getPair(int index) const
 {
-    if (index < 0 || index >= m_pairs.count())
+    if (index < 0 || index >= m_pairIndices.size())
         return TiePointPair();
-    return m_pairs.at(index);
+    
+    TiePointPair pair(m_pairIndices.at(index));
+    if (m_flags.at(index) & HasFixed)
+        pair.fixed = m_fixedPoints.at(index);
+    if (m_flags.at(index) & HasMoving)
+        pair.moving = m_movingPoints.at(index);
+    return pair;
 }
 
 QList<TiePointPair> TiePointModel::getAllPairs() const
 {
-    return m_pairs;
+    QList<TiePointPair> pairs;
+    pairs.reserve(m_pairIndices.size());
+    for (int row = 0; row < m_pairIndices.size(); ++row) {
+        pairs.append(getPair(row));
+    }
+    return pairs;
 }
 
 QList<TiePointPair> TiePointModel::getCompletePairs() const
 {
     QList<TiePointPair> complete;
-    for (const TiePointPair &pair : m_pairs) {
-        if (pair.isComplete()) {
-            complete.append(pair);
+    complete.reserve(m_completeCount);
+    for (int row = 0; row < m_pairIndices.size(); ++row) {
+        if (m_flags.at(row) == HasBoth) {
+            complete.append(getPair(row));
         }
     }
     return complete;
@@ -332,28 +497,63 @@ QList<TiePointPair> TiePointModel::getCompletePairs() const
 
 int TiePointModel::pairCount() const
 {
-    return m_pairs.count();
+    return m_pairIndices.size();
 }
 
 int TiePointModel::completePairCount() const
 {
-    int count = 0;
-    for (const TiePointPair &pair : m_pairs) {
-        if (pair.isComplete()) {
-            ++count;
-        }
-    }
-    return count;
+    return m_completeCount;
 }
 
 bool TiePointModel::hasBothPoints(int pairIndex) const
 {
-    for (const TiePointPair &pair : m_pairs) {
-        if (pair.index == pairIndex) {
-            return pair.isComplete();
-        }
+    const int row = rowOf(pairIndex);
+    return row >= 0 && m_flags.at(row) == HasBoth;
+}
+
+const QVector<double> &TiePointModel::packedCompletePairs() const
+{
+    if (m_packedDirty) {
+        // resize() keeps the capacity: steady-state rebuilds do not allocate
+        m_packedPairs.resize(4 * m_completeCount);
+        double *out = m_packedPairs.data();
+        forEachCompletePair([&out](int, const QPointF &fixed, const QPointF &moving) {
+            *out++ = fixed.x();
+            *out++ = fixed.y();
+            *out++ = moving.x();
+            *out++ = moving.y();
+        });
+        m_packedDirty = false;
+    }
+    return m_packedPairs;
+}
+
+void TiePointModel::setResidual(int row, float residual)
+{
+    if (row < 0 || row >= m_residuals.size())
+        return;
+    const float old = m_residuals.at(row);
+    if (old == residual || (qIsNaN(old) && qIsNaN(residual)))
+        return;
+    
+    m_residuals[row] = residual;
+    m_displayText[TextColumns * row + ColResidual - ColFixedX] = QString();
+    const QModelIndex cell = index(row, ColResidual);
+    emit dataChanged(cell, cell, {Qt::DisplayRole, Qt::EditRole});
+}
+
+void TiePointModel::setResiduals(const QVector<float> &residuals)
+{
+    if (residuals.size() != m_residuals.size())
+        return;
+    
+    m_residuals = residuals;
+    for (int row = 0; row < m_residuals.size(); ++row)
+        m_displayText[TextColumns * row + ColResidual - ColFixedX] = QString();
+    if (!m_residuals.isEmpty()) {
+        emit dataChanged(index(0, ColResidual), index(m_residuals.size() - 1, ColResidual),
+                         {Qt::DisplayRole, Qt::EditRole});
     }
-    return false;
 }
 
 // ============================================================================
@@ -364,73 +564,59 @@ void TiePointModel::addTiePoint(const QPointF &fixed, const QPointF &moving)
 {
     int pairIndex = getNextPairIndex();
     
-    m_fixedPoints.append(PointEntry(pairIndex, fixed));
-    m_movingPoints.append(PointEntry(pairIndex, moving));
-    
-    // Just rebuild pairs
-    rebuildPairs();
+    setPoints(pairIndex, HasBoth, fixed, moving);
     
     emit pairCompleted(pairIndex);
 }
 
 void TiePointModel::removeTiePoint(int index)
 {
-    if (index < 0 || index >= m_pairs.count())
+    if (index < 0 || index >= m_pairIndices.size())
         return;
 
-    int pairIndex = m_pairs.at(index).index;
-    
-    // Remove from fixed points
-    for (int i = m_fixedPoints.size() - 1; i >= 0; --i) {
-        if (m_fixedPoints[i].pairIndex == pairIndex) {
-            m_fixedPoints.removeAt(i);
-        }
-    }
-    
-    // Remove from moving points
-    for (int i = m_movingPoints.size() - 1; i >= 0; --i) {
-        if (m_movingPoints[i].pairIndex == pairIndex) {
-            m_movingPoints.removeAt(i);
-        }
-    }
+    int pairIndex = m_pairIndices.at(index);
     
-    rebuildPairs();
+    clearPoints(pairIndex, HasBoth);
     emit pointRemoved(pairIndex, true);
 }
 
 void TiePointModel::insertTiePoint(int index, const QPointF &fixed, const QPointF &moving, int pairIndex)
 {
+    Q_UNUSED(index);    // The row follows from the pair index
+    
     // If pairIndex is not specified, get the next available one
     if (pairIndex < 0) {
         pairIndex = getNextPairIndex();
     }
     
-    // Add to storage with the specified pairIndex
-    m_fixedPoints.append(PointEntry(pairIndex, fixed));
-    m_movingPoints.append(PointEntry(pairIndex, moving));
-    
-    // Rebuild pairs
-    rebuildPairs();
+    setPoints(pairIndex, HasBoth, fixed, moving);
     
     emit pairCompleted(pairIndex);
 }
 
 int TiePointModel::getPairIndexAt(int index) const
 {
-    if (index < 0 || index >= m_pairs.count())
+    if (index < 0 || index >= m_pairIndices.size())
         return -1;
-    return m_pairs.at(index).index;
+    return m_pairIndices.at(index);
 }
 
 void TiePointModel::clearAll()
 {
-    if (m_fixedPoints.isEmpty() && m_movingPoints.isEmpty())
+    if (m_pairIndices.isEmpty())
         return;
 
     beginResetModel();
+    m_pairIndices.clear();
     m_fixedPoints.clear();
     m_movingPoints.clear();
-    m_pairs.clear();
+    m_flags.clear();
+    m_residuals.clear();
+    m_displayText.clear();
+    m_completeCount = 0;
+    m_awaitingFixed.clear();
+    m_awaitingMoving.clear();
+    m_packedDirty = true;
     m_activeStack = ActiveStack::None;
     endResetModel();
     
@@ -439,24 +625,24 @@ void TiePointModel::clearAll()
 
 TiePoint TiePointModel::getTiePoint(int index) const
 {
-    if (index < 0 || index >= m_pairs.count())
+    if (index < 0 || index >= m_pairIndices.size())
         return TiePoint();
     
-    const TiePointPair &pair = m_pairs.at(index);
     TiePoint tp;
-    if (pair.hasFixed())
-        tp.fixed = *pair.fixed;
-    if (pair.hasMoving())
-        tp.moving = *pair.moving;
+    if (m_flags.at(index) & HasFixed)
+        tp.fixed = m_fixedPoints.at(index);
+    if (m_flags.at(index) & HasMoving)
+        tp.moving = m_movingPoints.at(index);
     return tp;
 }
 
 QList<TiePoint> TiePointModel::getAllTiePoints() const
 {
     QList<TiePoint> result;
-    for (const TiePointPair &pair : m_pairs) {
-        if (pair.isComplete()) {
-            result.append(TiePoint(*pair.fixed, *pair.moving));
+    result.reserve(m_completeCount);
+    for (int row = 0; row < m_pairIndices.size(); ++row) {
+        if (m_flags.at(row) == HasBoth) {
+            result.append(TiePoint(m_fixedPoints.at(row), m_movingPoints.at(row)));
         }
     }
     return result;
@@ -464,116 +650,149 @@ QList<TiePoint> TiePointModel::getAllTiePoints() const
 
 void TiePointModel::updateFixedPoint(int index, const QPointF &point)
 {
-    if (index < 0 || index >= m_pairs.count())
+    if (index < 0 || index >= m_pairIndices.size() || !(m_flags.at(index) & HasFixed))
         return;
 
-    int pairIndex = m_pairs.at(index).index;
-    int idx = findFixedPointIndex(pairIndex);
-    if (idx >= 0) {
-        m_fixedPoints[idx].position = point;
-        rebuildPairs();
-        
-        QModelIndex topLeft = createIndex(index, ColFixedX);
-        QModelIndex bottomRight = createIndex(index, ColFixedY);
-        emit dataChanged(topLeft, bottomRight);
-    }
+    m_fixedPoints[index] = point;
+    invalidateDisplayText(index, HasFixed);
+    m_packedDirty = true;
+    emit dataChanged(this->index(index, ColFixedX), this->index(index, ColFixedY));
 }
 
 void TiePointModel::updateMovingPoint(int index, const QPointF &point)
 {
-    if (index < 0 || index >= m_pairs.count())
+    if (index < 0 || index >= m_pairIndices.size() || !(m_flags.at(index) & HasMoving))
         return;
 
-    int pairIndex = m_pairs.at(index).index;
-    int idx = findMovingPointIndex(pairIndex);
-    if (idx >= 0) {
-        m_movingPoints[idx].position = point;
-        rebuildPairs();
-        
-        QModelIndex topLeft = createIndex(index, ColMovingX);
-        QModelIndex bottomRight = createIndex(index, ColMovingY);
-        emit dataChanged(topLeft, bottomRight);
-    }
+    m_movingPoints[index] = point;
+    invalidateDisplayText(index, HasMoving);
+    m_packedDirty = true;
+    emit dataChanged(this->index(index, ColMovingX), this->index(index, ColMovingY));
 }
 
 // ============================================================================
 // Private Helpers
 // ============================================================================
 
-void TiePointModel::rebuildPairs()
+int TiePointModel::lowerBoundRow(int pairIndex) const
 {
-    beginResetModel();
+    return int(std::lower_bound(m_pairIndices.cbegin(), m_pairIndices.cend(), pairIndex)
+               - m_pairIndices.cbegin());
+}
+
+int TiePointModel::rowOf(int pairIndex) const
+{
+    const int row = lowerBoundRow(pairIndex);
+    if (row < m_pairIndices.size() && m_pairIndices.at(row) == pairIndex)
+        return row;
+    return -1;
+}
+
+int TiePointModel::setPoints(int pairIndex, quint8 flags, const QPointF &fixed, const QPointF &moving)
+{
+    // New last pair is the common case: appended without a search
+    int row = (m_pairIndices.isEmpty() || m_pairIndices.last() < pairIndex)
+        ? m_pairIndices.size() : lowerBoundRow(pairIndex);
     
-    // Collect all unique pair indices
-    QSet<int> indices;
-    for (const PointEntry &entry : m_fixedPoints) {
-        indices.insert(entry.pairIndex);
-    }
-    for (const PointEntry &entry : m_movingPoints) {
-        indices.insert(entry.pairIndex);
+    if (row < m_pairIndices.size() && m_pairIndices.at(row) == pairIndex) {
+        // Existing pair: points are replaced in place
+        account(pairIndex, m_flags.at(row), -1);
+        if (flags & HasFixed)
+            m_fixedPoints[row] = fixed;
+        if (flags & HasMoving)
+            m_movingPoints[row] = moving;
+        m_flags[row] |= flags;
+        account(pairIndex, m_flags.at(row), 1);
+        invalidateDisplayText(row, flags);
+        
+        const int firstColumn = (flags & HasFixed) ? ColFixedX : ColMovingX;
+        const int lastColumn = (flags & HasMoving) ? ColMovingY : ColFixedY;
+        emit dataChanged(index(row, firstColumn), index(row, lastColumn));
+        return row;
     }
     
-    // Sort indices
-    QList<int> sortedIndices = indices.values();
-    std::sort(sortedIndices.begin(), sortedIndices.end());
+    beginInsertRows(QModelIndex(), row, row);
+    m_pairIndices.insert(row, pairIndex);
+    m_fixedPoints.insert(row, (flags & HasFixed) ? fixed : QPointF());
+    m_movingPoints.insert(row, (flags & HasMoving) ? moving : QPointF());
+    m_flags.insert(row, flags);
+    m_residuals.insert(row, qQNaN());
+    m_displayText.insert(TextColumns * row, TextColumns, QString());
+    account(pairIndex, flags, 1);
+    endInsertRows();
+    return row;
+}
+
+void TiePointModel::clearPoints(int pairIndex, quint8 flags)
+{
+    const int row = rowOf(pairIndex);
+    if (row < 0 || !(m_flags.at(row) & flags))
+        return;
     
-    // Build pairs
-    m_pairs.clear();
-    for (int idx : sortedIndices) {
-        TiePointPair pair(idx);
-        
-        // Find fixed point
-        for (const PointEntry &entry : m_fixedPoints) {
-            if (entry.pairIndex == idx) {
-                pair.fixed = entry.position;
-                break;
-            }
-        }
-        
-        // Find moving point
-        for (const PointEntry &entry : m_movingPoints) {
-            if (entry.pairIndex == idx) {
-                pair.moving = entry.position;
-                break;
-            }
-        }
-        
-        m_pairs.append(pair);
+    account(pairIndex, m_flags.at(row), -1);
+    const quint8 remaining = m_flags.at(row) & ~flags;
+    
+    if (remaining == 0) {
+        beginRemoveRows(QModelIndex(), row, row);
+        removeRowRange(row, 1);
+        endRemoveRows();
+        return;
     }
     
-    endResetModel();
+    m_flags[row] = remaining;
+    if (flags & HasFixed)
+        m_fixedPoints[row] = QPointF();
+    if (flags & HasMoving)
+        m_movingPoints[row] = QPointF();
+    account(pairIndex, remaining, 1);
+    invalidateDisplayText(row, flags);
+    
+    const int firstColumn = (flags & HasFixed) ? ColFixedX : ColMovingX;
+    const int lastColumn = (flags & HasMoving) ? ColMovingY : ColFixedY;
+    emit dataChanged(index(row, firstColumn), index(row, lastColumn));
 }
 
-int TiePointModel::getNextPairIndex() const
+void TiePointModel::account(int pairIndex, quint8 flags, int sign)
 {
-    int maxIndex = -1;
-    for (const PointEntry &entry : m_fixedPoints) {
-        maxIndex = qMax(maxIndex, entry.pairIndex);
-    }
-    for (const PointEntry &entry : m_movingPoints) {
-        maxIndex = qMax(maxIndex, entry.pairIndex);
+    // Every add or remove passes through here
+    m_packedDirty = true;
+    
+    // Inserts are hinted at the end: new pairs come in ascending order
+    switch (flags) {
+    case HasBoth:
+        m_completeCount += sign;
+        break;
+    case HasMoving:
+        if (sign > 0)
+            m_awaitingFixed.insert(m_awaitingFixed.end(), pairIndex);
+        else
+            m_awaitingFixed.erase(pairIndex);
+        break;
+    case HasFixed:
+        if (sign > 0)
+            m_awaitingMoving.insert(m_awaitingMoving.end(), pairIndex);
+        else
+            m_awaitingMoving.erase(pairIndex);
+        break;
+    default:
+        break;
     }
-    return maxIndex + 1;
 }
 
-int TiePointModel::findFixedPointIndex(int pairIndex) const
+void TiePointModel::removeRowRange(int row, int count)
 {
-    for (int i = 0; i < m_fixedPoints.size(); ++i) {
-        if (m_fixedPoints[i].pairIndex == pairIndex) {
-            return i;
-        }
-    }
-    return -1;
+    m_pairIndices.remove(row, count);
+    m_fixedPoints.remove(row, count);
+    m_movingPoints.remove(row, count);
+    m_flags.remove(row, count);
+    m_residuals.remove(row, count);
+    m_displayText.remove(TextColumns * row, TextColumns * count);
 }
 
-int TiePointModel::findMovingPointIndex(int pairIndex) const
+int TiePointModel::getNextPairIndex() const
 {
-    for (int i = 0; i < m_movingPoints.size(); ++i) {
-        if (m_movingPoints[i].pairIndex == pairIndex) {
-            return i;
-        }
-    }
-    return -1;
+    // Rows are ordered by pair index
+    return m_pairIndices.isEmpty() ? 0 : m_pairIndices.last() + 1;
 }
 
 // ============================================================================
@@ -582,12 +801,24 @@ int TiePointModel::findMovingPointIndex(int pairIndex) const
 
 void TiePointModel::setDisplayCoordinateOffset(const QPointF &fixedOffset, const QPointF &movingOffset)
 {
+    quint8 changed = 0;
+    if (fixedOffset != m_fixedOffset)
+        changed |= HasFixed;
+    if (movingOffset != m_movingOffset)
+        changed |= HasMoving;
     m_fixedOffset = fixedOffset;
     m_movingOffset = movingOffset;
     
-    // Notify that all data has changed (for display refresh)
-    if (m_pairs.count() > 0) {
-        emit dataChanged(index(0, ColFixedX), index(m_pairs.count() - 1, ColMovingY));
+    // Offsets are only displayed with center origin
+    if (m_useTopLeftOrigin || !changed)
+        return;
+    
+    invalidateDisplayText(changed);
+    if (!m_pairIndices.isEmpty()) {
+        const int firstColumn = (changed & HasFixed) ? ColFixedX : ColMovingX;
+        const int lastColumn = (changed & HasMoving) ? ColMovingY : ColFixedY;
+        emit dataChanged(index(0, firstColumn), index(m_pairIndices.size() - 1, lastColumn),
+                         {Qt::DisplayRole, Qt::EditRole});
     }
 }
 
@@ -596,13 +827,52 @@ void TiePointModel::setUseTopLeftOrigin(bool useTopLeft)
     if (m_useTopLeftOrigin != useTopLeft) {
         m_useTopLeftOrigin = useTopLeft;
         
-        // Notify that all data has changed
-        if (m_pairs.count() > 0) {
-            emit dataChanged(index(0, ColFixedX), index(m_pairs.count() - 1, ColMovingY));
+        // Every coordinate text changes; the points themselves do not
+        invalidateDisplayText(HasBoth);
+        if (!m_pairIndices.isEmpty()) {
+            emit dataChanged(index(0, ColFixedX), index(m_pairIndices.size() - 1, ColMovingY),
+                             {Qt::DisplayRole, Qt::EditRole});
         }
     }
 }
 
+const QString &TiePointModel::displayText(int row, int column) const
+{
+    QString &text = m_displayText[TextColumns * row + column - ColFixedX];
+    if (text.isNull() && column == ColResidual) {
+        const float residual = m_residuals.at(row);
+        text = qIsNaN(residual) ? QStringLiteral("-") : QString::number(residual, 'f', 2);
+    } else if (text.isNull()) {
+        const bool isFixed = column == ColFixedX || column == ColFixedY;
+        if (m_flags.at(row) & (isFixed ? HasFixed : HasMoving)) {
+            const QPointF displayPos = toDisplayCoord(isFixed ? m_fixedPoints.at(row) : m_movingPoints.at(row), isFixed);
+            const bool isX = column == ColFixedX || column == ColMovingX;
+            text = QString::number(isX ? displayPos.x() : displayPos.y(), 'f', 2);
+        } else {
+            text = QStringLiteral("-");
+        }
+    }
+    return text;
+}
+
+void TiePointModel::invalidateDisplayText(int row, quint8 flags)
+{
+    if (flags & HasFixed) {
+        m_displayText[TextColumns * row] = QString();
+        m_displayText[TextColumns * row + 1] = QString();
+    }
+    if (flags & HasMoving) {
+        m_displayText[TextColumns * row + 2] = QString();
+        m_displayText[TextColumns * row + 3] = QString();
+    }
+}
+
+void TiePointModel::invalidateDisplayText(quint8 flags)
+{
+    for (int row = 0; row < m_pairIndices.size(); ++row)
+        invalidateDisplayText(row, flags);
+}
+
 QPointF TiePointModel::toDisplayCoord(const QPointF &pixelPos, bool isFixed) const
 {
     if (m_useTopLeftOrigin) {
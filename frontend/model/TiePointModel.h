@@ -4,18 +4,9 @@
 #include <QAbstractTableModel>
 #include <QList>
 #include <QPointF>
+#include <QVector>
 #include <optional>
-
-/**
- * @brief Represents a single tie point entry (fixed or moving point with index).
- */
-struct PointEntry {
-    int pairIndex;      // Index of the point pair (0, 1, 2, ...)
-    QPointF position;   // Point coordinates
-    
-    PointEntry() : pairIndex(-1) {}
-    PointEntry(int idx, const QPointF& pos) : pairIndex(idx), position(pos) {}
-};
+#include <set>
 
 /**
  * @brief Represents a complete or partial tie point pair.
@@ -41,6 +32,45 @@ struct TiePoint {
     TiePoint(const QPointF& f, const QPointF& m) : fixed(f), moving(m) {}
 };
 
+/**
+ * @brief Compact copy of a set of pairs, in pair index order (undo snapshots).
+ */
+struct TiePointBatch {
+    QVector<int> pairIndices;
+    QVector<QPointF> fixedPoints;       // Meaningful where flags has the fixed bit
+    QVector<QPointF> movingPoints;      // Meaningful where flags has the moving bit
+    QVector<quint8> flags;              // Bit 0: fixed point, bit 1: moving point
+    
+    // Bytes held per pair
+    static constexpr qint64 BytesPerPair = sizeof(int) + 2 * sizeof(QPointF) + sizeof(quint8);
+    
+    int size() const { return pairIndices.size(); }
+    bool isEmpty() const { return pairIndices.isEmpty(); }
+};
+
+/**
+ * @brief Read-only view over a contiguous range of TiePointModel storage.
+ *
+ * Does not own or copy anything; valid until the model is next modified.
+ */
+template <typename T>
+class TiePointSpan {
+public:
+    TiePointSpan() = default;
+    TiePointSpan(const T *data, int size) : m_data(data), m_size(size) {}
+    
+    const T *data() const { return m_data; }
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    const T &operator[](int i) const { return m_data[i]; }
+    const T *begin() const { return m_data; }
+    const T *end() const { return m_data + m_size; }
+
+private:
+    const T *m_data = nullptr;
+    int m_size = 0;
+};
+
 /**
  * @brief Enum to identify which image/stack is active.
  */
@@ -53,9 +83,22 @@ enum class ActiveStack {
 /**
  * @brief Model for managing tie points between two images.
  * 
- * Uses separate storage for fixed and moving points, with index-based pairing.
- * Supports partial pairs (only fixed or only moving point set).
- * Undo/Redo is now managed externally via QUndoStack in MainWindow.
+ * One row per pair, ordered by pair index. Rows are stored as parallel
+ * contiguous arrays (pair index, fixed point, moving point, presence flags),
+ * so a pair index is found by binary search and a row is read without
+ * pointer chasing. Supports partial pairs (only fixed or only moving point set).
+ *
+ * Edits are reported precisely: a new pair inserts one row, an emptied pair
+ * removes one row, and anything else is a dataChanged() on the touched
+ * cells, so views keep their selection and scroll position. Partial pairs
+ * are kept in ordered sets and complete pairs are counted incrementally, so
+ * adding a point costs O(log n) (O(1) amortized for a new last pair).
+ *
+ * Coordinate cell text is formatted on first request and cached per row;
+ * edits drop only the touched cells, and origin/offset changes only the
+ * side they affect, so repainting and scrolling do no formatting work.
+ *
+ * Undo/Redo is managed externally via QUndoStack in MainWindow.
  */
 class TiePointModel : public QAbstractTableModel
 {
@@ -68,6 +111,7 @@ public:
         ColFixedY,
         ColMovingX,
         ColMovingY,
+        ColResidual,
         ColCount
     };
 
@@ -88,6 +132,21 @@ public:
     int addMovingPointDirect(int pairIndex, const QPointF &point); // Add to specific pair
     void removePointDirect(int pairIndex, bool isFixed);           // Remove specific point
     
+    // Bulk insert: appends the pairs (partial ones included, empty ones skipped)
+    // as new pairs after the last one, in one rows-inserted notification, or
+    // one reset when the model is empty. Pair indices are renumbered in order.
+    // No per-pair signals are emitted. Returns the number of pairs added.
+    int appendPairs(const QList<TiePointPair> &pairs);
+    
+    // Undo snapshots: takePairs() removes the given pairs and returns their
+    // contents; restorePairs() puts such a batch back at its pair indices
+    // (which must be free). A few contiguous row ranges are reported as row
+    // removes/inserts, scattered ones as a single reset.
+    TiePointBatch takePairs(QVector<int> pairIndices);
+    void restorePairs(const TiePointBatch &batch);
+    // Moves an existing point of a pair (no-op if the pair lacks that side)
+    void movePointDirect(int pairIndex, bool isFixed, const QPointF &point);
+    
     // Query methods
     TiePointPair getPair(int index) const;
     QList<TiePointPair> getAllPairs() const;
@@ -97,6 +156,38 @@ public:
     ActiveStack getActiveStack() const { return m_activeStack; }
     bool hasBothPoints(int pairIndex) const;       // Check if pair is complete
     int getNextPairIndex() const;                  // Get next available pair index
+    int rowOf(int pairIndex) const;                // Row of a pair, -1 if it has no points (O(log n))
+    
+    // Zero-copy reads (no allocation), one entry per row; a point is only
+    // meaningful where the matching hasFixedAt()/hasMovingAt() is true
+    TiePointSpan<int> pairIndices() const { return {m_pairIndices.constData(), int(m_pairIndices.size())}; }
+    TiePointSpan<QPointF> fixedPoints() const { return {m_fixedPoints.constData(), int(m_fixedPoints.size())}; }
+    TiePointSpan<QPointF> movingPoints() const { return {m_movingPoints.constData(), int(m_movingPoints.size())}; }
+    bool hasFixedAt(int row) const { return m_flags.at(row) & HasFixed; }
+    bool hasMovingAt(int row) const { return m_flags.at(row) & HasMoving; }
+    bool isCompleteAt(int row) const { return m_flags.at(row) == HasBoth; }
+    
+    // Per-row residual in pixels under the current transform (NaN: unknown),
+    // shown in ColResidual. Set by whoever owns the transform; new and
+    // restored rows start unknown.
+    float residualAt(int row) const { return m_residuals.at(row); }
+    void setResidual(int row, float residual);
+    void setResiduals(const QVector<float> &residuals);    // One per row
+    
+    // Calls f(row, fixed, moving) for every complete pair, in row order
+    template <typename F>
+    void forEachCompletePair(F &&f) const
+    {
+        for (int row = 0; row < m_pairIndices.size(); ++row) {
+            if (m_flags.at(row) == HasBoth)
+                f(row, m_fixedPoints.at(row), m_movingPoints.at(row));
+        }
+    }
+    
+    // Complete pairs packed for solvers: completePairCount() rows of
+    // (fixed x, fixed y, moving x, moving y), pixel coordinates. Rebuilt
+    // lazily after a change, into the same buffer; valid until the next change.
+    const QVector<double> &packedCompletePairs() const;
     
     // Legacy compatibility
     void addTiePoint(const QPointF &fixed, const QPointF &moving);
@@ -124,20 +215,53 @@ signals:
     void modelCleared();
 
 private:
-    void rebuildPairs();
-    int findFixedPointIndex(int pairIndex) const;
-    int findMovingPointIndex(int pairIndex) const;
+    // Above this many row ranges, a batch edit is reported as a reset
+    static constexpr int MaxBatchRanges = 16;
+    // Cached text cells per row: ColFixedX..ColResidual
+    static constexpr int TextColumns = ColCount - ColFixedX;
+    
+    enum PointFlag : quint8 {
+        HasFixed = 0x1,
+        HasMoving = 0x2,
+        HasBoth = HasFixed | HasMoving
+    };
+    
+    int lowerBoundRow(int pairIndex) const;
+    // Sets the flagged points of a pair, inserting its row if needed; returns the row
+    int setPoints(int pairIndex, quint8 flags, const QPointF &fixed, const QPointF &moving);
+    // Clears the flagged points of a pair, removing its row once empty
+    void clearPoints(int pairIndex, quint8 flags);
+    // Adds (sign 1) or removes (sign -1) a pair's state from the bookkeeping
+    void account(int pairIndex, quint8 flags, int sign);
+    void removeRowRange(int row, int count);
+    // Formatted text of a coordinate cell, cached until invalidated
+    const QString &displayText(int row, int column) const;
+    void invalidateDisplayText(int row, quint8 flags);
+    void invalidateDisplayText(quint8 flags);   // All rows
     
-    // Separate storage for points
-    QList<PointEntry> m_fixedPoints;
-    QList<PointEntry> m_movingPoints;
+    // Rows, ordered by pair index; one entry per row in each array
+    QVector<int> m_pairIndices;
+    QVector<QPointF> m_fixedPoints;
+    QVector<QPointF> m_movingPoints;
+    QVector<quint8> m_flags;
+    QVector<float> m_residuals;
+    
+    // Bookkeeping for O(log n) lookups
+    int m_completeCount = 0;
+    std::set<int> m_awaitingFixed;      // Pairs with only a moving point
+    std::set<int> m_awaitingMoving;     // Pairs with only a fixed point
+    
+    // Cell text, TextColumns per row; null until formatted, so scrolling
+    // only formats rows that were never shown
+    mutable QVector<QString> m_displayText;
+    
+    // Cache behind packedCompletePairs(), invalidated by every change
+    mutable QVector<double> m_packedPairs;
+    mutable bool m_packedDirty = true;
     
     // Current active stack (which was last modified)
     ActiveStack m_activeStack;
     
-    // Cached pairs for efficient access
-    QList<TiePointPair> m_pairs;
-    
     // Coordinate display settings
     bool m_useTopLeftOrigin = false;  // false = center origin (default)
     QPointF m_fixedOffset;            // Image center offset for fixed image
@@ -0,0 +1,310 @@
+#include "TiePointProxyModel.h"
+#include "TiePointModel.h"
+#include <QtNumeric>
+#include <algorithm>
+
+TiePointProxyModel::TiePointProxyModel(TiePointModel *model, QObject *parent)
+    : QAbstractProxyModel(parent)
+    , m_model(model)
+    , m_sortColumn(TiePointModel::ColIndex)
+    , m_sortOrder(Qt::AscendingOrder)
+    , m_minResidual(0.0f)
+    , m_passThrough(true)
+{
+    QAbstractProxyModel::setSourceModel(model);
+
+    connect(model, &QAbstractItemModel::dataChanged, this, &TiePointProxyModel::onSourceDataChanged);
+    connect(model, &QAbstractItemModel::rowsAboutToBeInserted,
+            this, &TiePointProxyModel::onSourceRowsAboutToBeInserted);
+    connect(model, &QAbstractItemModel::rowsInserted, this, &TiePointProxyModel::onSourceRowsInserted);
+    connect(model, &QAbstractItemModel::rowsAboutToBeRemoved,
+            this, &TiePointProxyModel::onSourceRowsAboutToBeRemoved);
+    connect(model, &QAbstractItemModel::rowsRemoved, this, &TiePointProxyModel::onSourceRowsRemoved);
+    connect(model, &QAbstractItemModel::modelAboutToBeReset, this, &TiePointProxyModel::beginResetModel);
+    connect(model, &QAbstractItemModel::modelReset, this, &TiePointProxyModel::onSourceReset);
+}
+
+// ============================================================================
+// QAbstractProxyModel Interface
+// ============================================================================
+
+QModelIndex TiePointProxyModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (parent.isValid() || row < 0 || row >= rowCount() || column < 0 || column >= columnCount())
+        return QModelIndex();
+    return createIndex(row, column);
+}
+
+QModelIndex TiePointProxyModel::parent(const QModelIndex &child) const
+{
+    Q_UNUSED(child);
+    return QModelIndex();
+}
+
+int TiePointProxyModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_passThrough ? m_model->rowCount() : m_proxyToSource.size();
+}
+
+int TiePointProxyModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return TiePointModel::ColCount;
+}
+
+QVariant TiePointProxyModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    // Columns are never reordered; the base class would map through row 0
+    return m_model->headerData(section, orientation, role);
+}
+
+QModelIndex TiePointProxyModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!proxyIndex.isValid())
+        return QModelIndex();
+    return m_model->index(sourceRow(proxyIndex.row()), proxyIndex.column());
+}
+
+QModelIndex TiePointProxyModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!sourceIndex.isValid())
+        return QModelIndex();
+    const int row = proxyRow(sourceIndex.row());
+    return row >= 0 ? index(row, sourceIndex.column()) : QModelIndex();
+}
+
+void TiePointProxyModel::sort(int column, Qt::SortOrder order)
+{
+    if (column < 0 || column >= TiePointModel::ColCount) {
+        column = TiePointModel::ColIndex;
+        order = Qt::AscendingOrder;
+    }
+    if (column == m_sortColumn && order == m_sortOrder)
+        return;
+
+    m_sortColumn = column;
+    m_sortOrder = order;
+    relayout();
+}
+
+void TiePointProxyModel::setMinResidual(float minResidual)
+{
+    minResidual = qMax(0.0f, minResidual);
+    if (minResidual == m_minResidual)
+        return;
+
+    m_minResidual = minResidual;
+    relayout();
+}
+
+// ============================================================================
+// Permutation
+// ============================================================================
+
+bool TiePointProxyModel::wantsPassThrough() const
+{
+    return m_sortColumn == TiePointModel::ColIndex && m_sortOrder == Qt::AscendingOrder
+        && m_minResidual <= 0.0f;
+}
+
+bool TiePointProxyModel::dependsOnResidual() const
+{
+    return m_sortColumn == TiePointModel::ColResidual || m_minResidual > 0.0f;
+}
+
+QVector<int> TiePointProxyModel::buildPermutation() const
+{
+    QVector<int> proxyToSource;
+    if (wantsPassThrough())
+        return proxyToSource;
+
+    const int rowCount = m_model->rowCount();
+    proxyToSource.reserve(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        // NaN never passes the comparison, so unknown residuals are hidden
+        if (m_minResidual <= 0.0f || m_model->residualAt(row) >= m_minResidual)
+            proxyToSource.append(row);
+    }
+
+    if (m_sortColumn == TiePointModel::ColIndex) {
+        if (m_sortOrder == Qt::DescendingOrder)
+            std::reverse(proxyToSource.begin(), proxyToSource.end());
+        return proxyToSource;
+    }
+
+    // Keys are gathered once, so the sort only compares plain doubles
+    struct Entry {
+        double key;
+        int row;
+    };
+    const TiePointSpan<QPointF> fixed = m_model->fixedPoints();
+    const TiePointSpan<QPointF> moving = m_model->movingPoints();
+    QVector<Entry> entries;
+    entries.reserve(proxyToSource.size());
+    for (int row : proxyToSource) {
+        double key = qQNaN();
+        switch (m_sortColumn) {
+        case TiePointModel::ColFixedX:
+            if (m_model->hasFixedAt(row))
+                key = fixed[row].x();
+            break;
+        case TiePointModel::ColFixedY:
+            if (m_model->hasFixedAt(row))
+                key = fixed[row].y();
+            break;
+        case TiePointModel::ColMovingX:
+            if (m_model->hasMovingAt(row))
+                key = moving[row].x();
+            break;
+        case TiePointModel::ColMovingY:
+            if (m_model->hasMovingAt(row))
+                key = moving[row].y();
+            break;
+        case TiePointModel::ColResidual:
+            key = m_model->residualAt(row);
+            break;
+        }
+        entries.append({key, row});
+    }
+
+    // Unknown keys last in both orders; ties keep index order
+    const bool ascending = m_sortOrder == Qt::AscendingOrder;
+    std::sort(entries.begin(), entries.end(), [ascending](const Entry &a, const Entry &b) {
+        const bool aUnknown = qIsNaN(a.key);
+        const bool bUnknown = qIsNaN(b.key);
+        if (aUnknown || bUnknown)
+            return aUnknown == bUnknown ? a.row < b.row : bUnknown;
+        if (a.key != b.key)
+            return ascending ? a.key < b.key : a.key > b.key;
+        return a.row < b.row;
+    });
+
+    for (int i = 0; i < entries.size(); ++i)
+        proxyToSource[i] = entries.at(i).row;
+    return proxyToSource;
+}
+
+void TiePointProxyModel::applyPermutation(const QVector<int> &proxyToSource)
+{
+    m_passThrough = wantsPassThrough();
+    m_proxyToSource = proxyToSource;
+    m_sourceToProxy.clear();
+    if (m_passThrough)
+        return;
+
+    m_sourceToProxy.fill(-1, m_model->rowCount());
+    for (int i = 0; i < m_proxyToSource.size(); ++i)
+        m_sourceToProxy[m_proxyToSource.at(i)] = i;
+}
+
+void TiePointProxyModel::relayout()
+{
+    const QVector<int> proxyToSource = buildPermutation();
+    const int newRowCount = wantsPassThrough() ? m_model->rowCount() : proxyToSource.size();
+    if (newRowCount != rowCount()) {
+        beginResetModel();
+        applyPermutation(proxyToSource);
+        endResetModel();
+        return;
+    }
+
+    // Same number of rows: persistent indexes (the selection) follow their source rows
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+    const QModelIndexList from = persistentIndexList();
+    QVector<int> sourceRows;
+    sourceRows.reserve(from.size());
+    for (const QModelIndex &index : from)
+        sourceRows.append(sourceRow(index.row()));
+
+    applyPermutation(proxyToSource);
+
+    QModelIndexList to;
+    to.reserve(from.size());
+    for (int i = 0; i < from.size(); ++i) {
+        const int row = proxyRow(sourceRows.at(i));
+        to.append(row >= 0 ? index(row, from.at(i).column()) : QModelIndex());
+    }
+    changePersistentIndexList(from, to);
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+// ============================================================================
+// Source Model Changes
+// ============================================================================
+
+void TiePointProxyModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                                             const QList<int> &roles)
+{
+    if (m_passThrough) {
+        emit dataChanged(index(topLeft.row(), topLeft.column()),
+                         index(bottomRight.row(), bottomRight.column()), roles);
+        return;
+    }
+
+    // New residuals for every row (a new transform) rank the rows anew
+    const bool allRows = topLeft.row() == 0 && bottomRight.row() == m_model->rowCount() - 1;
+    if (allRows && dependsOnResidual()
+        && topLeft.column() <= TiePointModel::ColResidual
+        && bottomRight.column() >= TiePointModel::ColResidual) {
+        relayout();
+        return;
+    }
+
+    if (m_proxyToSource.isEmpty())
+        return;
+    if (bottomRight.row() - topLeft.row() >= MaxMappedRows) {
+        emit dataChanged(index(0, topLeft.column()),
+                         index(m_proxyToSource.size() - 1, bottomRight.column()), roles);
+        return;
+    }
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const int mapped = proxyRow(row);
+        if (mapped >= 0)
+            emit dataChanged(index(mapped, topLeft.column()), index(mapped, bottomRight.column()), roles);
+    }
+}
+
+void TiePointProxyModel::onSourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last)
+{
+    if (m_passThrough)
+        beginInsertRows(parent, first, last);
+    else
+        beginResetModel();
+}
+
+void TiePointProxyModel::onSourceRowsInserted()
+{
+    if (m_passThrough) {
+        endInsertRows();
+        return;
+    }
+    applyPermutation(buildPermutation());
+    endResetModel();
+}
+
+void TiePointProxyModel::onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (m_passThrough)
+        beginRemoveRows(parent, first, last);
+    else
+        beginResetModel();
+}
+
+void TiePointProxyModel::onSourceRowsRemoved()
+{
+    if (m_passThrough) {
+        endRemoveRows();
+        return;
+    }
+    applyPermutation(buildPermutation());
+    endResetModel();
+}
+
+void TiePointProxyModel::onSourceReset()
+{
+    applyPermutation(buildPermutation());
+    endResetModel();
+}
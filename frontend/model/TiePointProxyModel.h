@@ -0,0 +1,87 @@
+#ifndef TIEPOINTPROXYMODEL_H
+#define TIEPOINTPROXYMODEL_H
+
+#include <QAbstractProxyModel>
+#include <QVector>
+
+class TiePointModel;
+
+/**
+ * @brief Sorted and filtered view of a TiePointModel for the tie point table.
+ *
+ * Rows are mapped through a precomputed permutation: sorting gathers one key
+ * per row from the model's arrays and sorts (key, row) entries once, and the
+ * filter keeps only rows whose residual reaches a threshold. Mapping a row
+ * either way is an array lookup. In index order without a filter the proxy
+ * is a pass-through: no permutation is held and row inserts and removals are
+ * forwarded as such, so large point sets cost nothing extra.
+ *
+ * The order is a snapshot. Edits to single rows (a dragged point, its new
+ * residual) update the cells in place and do not move rows; a sort, a filter
+ * change or a new set of residuals computes the order again, keeping the
+ * selection when the visible rows stay the same. While sorted or filtered,
+ * inserted or removed rows reset the proxy.
+ *
+ * Unknown values (missing points, residuals not computed) sort last in both
+ * orders and are hidden by the residual filter.
+ */
+class TiePointProxyModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit TiePointProxyModel(TiePointModel *model, QObject *parent = nullptr);
+
+    // QAbstractProxyModel interface
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // Row mapping without model indexes
+    int sourceRow(int proxyRow) const { return m_passThrough ? proxyRow : m_proxyToSource.at(proxyRow); }
+    int proxyRow(int sourceRow) const { return m_passThrough ? sourceRow : m_sourceToProxy.value(sourceRow, -1); }
+
+    // Only rows with a residual of at least minResidual pixels; 0 shows all
+    void setMinResidual(float minResidual);
+    float minResidual() const { return m_minResidual; }
+
+    int sortColumn() const { return m_sortColumn; }
+    Qt::SortOrder sortOrder() const { return m_sortOrder; }
+    bool isPassThrough() const { return m_passThrough; }
+
+private:
+    // Above this many changed rows, a sorted dataChanged() covers all rows
+    static constexpr int MaxMappedRows = 64;
+
+    bool wantsPassThrough() const;
+    bool dependsOnResidual() const;
+    // Visible source rows in display order (empty when passing through)
+    QVector<int> buildPermutation() const;
+    void applyPermutation(const QVector<int> &proxyToSource);
+    // Recomputes the order: a layout change if the row count stays, else a reset
+    void relayout();
+
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                             const QList<int> &roles);
+    void onSourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last);
+    void onSourceRowsInserted();
+    void onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onSourceRowsRemoved();
+    void onSourceReset();
+
+    TiePointModel *m_model;
+    int m_sortColumn;
+    Qt::SortOrder m_sortOrder;
+    float m_minResidual;
+
+    bool m_passThrough;
+    QVector<int> m_proxyToSource;
+    QVector<int> m_sourceToProxy;   // -1 for filtered out rows
+};
+
+#endif // TIEPOINTPROXYMODEL_H
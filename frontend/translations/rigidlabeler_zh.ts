@@ -1130,6 +1130,176 @@ ID: %1
         <source>Restored last project: %1</source>
         <translation type="unfinished"></translation>
     </message>
+    <message>
+        <location filename="../mainwindow.ui" line="411"/>
+        <source>Display</source>
+        <translation>显示</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="417"/>
+        <source>Image:</source>
+        <translation>图像：</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="424"/>
+        <source>Image whose contrast the controls below adjust</source>
+        <translation>下方控件调整对比度的目标图像</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="428"/>
+        <source>Fixed</source>
+        <translation>固定图</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="433"/>
+        <source>Moving</source>
+        <translation>移动图</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="441"/>
+        <source>Level:</source>
+        <translation>窗位：</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="448"/>
+        <source>Center of the displayed sample range</source>
+        <translation>显示采样范围的中心</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="464"/>
+        <source>Window:</source>
+        <translation>窗宽：</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="471"/>
+        <source>Width of the displayed sample range (narrower = more contrast)</source>
+        <translation>显示采样范围的宽度（越窄对比度越高）</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="490"/>
+        <source>Gamma:</source>
+        <translation>Gamma：</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="518"/>
+        <source>Auto</source>
+        <translation>自动</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="521"/>
+        <source>Stretch the window over the 0.5%-99.5% sample percentiles</source>
+        <translation>将窗口拉伸到采样值的 0.5%–99.5% 分位</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="528"/>
+        <source>Reset</source>
+        <translation>重置</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="531"/>
+        <source>Show the full sample range without gamma</source>
+        <translation>显示完整采样范围，不做 Gamma 校正</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.cpp" line="2856"/>
+        <source>Restoring project: indexing %1...</source>
+        <translation>正在恢复项目：索引 %1...</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.cpp" line="2886"/>
+        <source>Restoring project: loading images...</source>
+        <translation>正在恢复项目：加载图像...</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="858"/>
+        <source>Magnifier &amp;Loupe</source>
+        <translation>放大镜(&amp;L)</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="861"/>
+        <source>Show a magnified patch of the image next to the cursor (Alt+Wheel changes the magnification)</source>
+        <translation>在光标旁显示图像的放大区域（Alt+滚轮调整放大倍数）</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="872"/>
+        <source>&amp;Bicubic Loupe Filtering</source>
+        <translation>放大镜双三次插值(&amp;B)</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="542"/>
+        <source>Warp overlay</source>
+        <translation>配准叠加</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="545"/>
+        <source>Draw the moving image, warped by the computed transform, over the fixed image</source>
+        <translation>将按计算出的变换形变后的移动图像叠加在固定图像上</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="556"/>
+        <source>Blend</source>
+        <translation>混合</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="561"/>
+        <source>Difference</source>
+        <translation>差值</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="571"/>
+        <source>Opacity:</source>
+        <translation>不透明度：</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="581"/>
+        <source>Opacity of the warp overlay</source>
+        <translation>配准叠加的不透明度</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.cpp" line="1370"/>
+        <source>Clear All Tie Points</source>
+        <translation>清空所有对应点</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.cpp" line="2403"/>
+        <source>Change too large for the undo history; it cannot be undone.</source>
+        <translation>修改过大，超出撤销历史的内存上限，无法撤销。</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.cpp" line="2476"/>
+        <source>Point #%1: (%2, %3)</source>
+        <translation>点 #%1: (%2, %3)</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.cpp" line="2483"/>
+        <source>Residual: %1 px  RMS: %2 px</source>
+        <translation>残差: %1 px  RMS: %2 px</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.cpp" line="2503"/>
+        <source>Point move cancelled</source>
+        <translation>已取消移动点</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.cpp" line="2511"/>
+        <source>Point #%1 moved.</source>
+        <translation>点 #%1 已移动。</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="221"/>
+        <source>Residual at least:</source>
+        <translation>残差不小于：</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="228"/>
+        <source>Only list tie points whose residual is at least this many pixels</source>
+        <translation>仅列出残差不小于该像素值的同名点</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.ui" line="231"/>
+        <source>All</source>
+        <translation>全部</translation>
+    </message>
 </context>
 <context>
     <name>PreviewDialog</name>
@@ -1300,6 +1470,21 @@ ID: %1
         <source>Select Fixed Point</source>
         <translation type="vanished">选择固定点</translation>
     </message>
+    <message>
+        <location filename="../mainwindow.cpp" line="143"/>
+        <source>Import %1 Tie Point(s)</source>
+        <translation>导入 %1 个对应点</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.cpp" line="188"/>
+        <source>Move Fixed Point</source>
+        <translation>移动固定图像上的点</translation>
+    </message>
+    <message>
+        <location filename="../mainwindow.cpp" line="188"/>
+        <source>Move Moving Point</source>
+        <translation>移动移动图像上的点</translation>
+    </message>
 </context>
 <context>
     <name>TiePointModel</name>
@@ -1332,5 +1517,36 @@ ID: %1
         <source>Point adding cancelled</source>
         <translation type="vanished">已取消添加点</translation>
     </message>
+    <message>
+        <location filename="../model/TiePointModel.cpp" line="87"/>
+        <source>Residual</source>
+        <translation>残差</translation>
+    </message>
+</context>
+<context>
+    <name>FilmstripDock</name>
+    <message>
+        <location filename="../view/FilmstripDock.cpp" line="10"/>
+        <source>Filmstrip</source>
+        <translation>缩略图条</translation>
+    </message>
+    <message>
+        <location filename="../view/FilmstripDock.cpp" line="22"/>
+        <source>Fixed</source>
+        <translation>固定图像</translation>
+    </message>
+    <message>
+        <location filename="../view/FilmstripDock.cpp" line="24"/>
+        <source>Moving</source>
+        <translation>移动图像</translation>
+    </message>
+</context>
+<context>
+    <name>ThumbnailListModel</name>
+    <message>
+        <location filename="../model/ThumbnailListModel.cpp" line="51"/>
+        <source>%1 (%2/%3)</source>
+        <translation>%1 (%2/%3)</translation>
+    </message>
 </context>
 </TS>
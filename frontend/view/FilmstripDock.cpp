@@ -0,0 +1,87 @@
+#include "FilmstripDock.h"
+#include "model/ThumbnailCache.h"
+#include "model/ThumbnailListModel.h"
+#include <QLabel>
+#include <QListView>
+#include <QScrollBar>
+#include <QVBoxLayout>
+
+FilmstripDock::FilmstripDock(ThumbnailCache *cache, QWidget *parent)
+    : QDockWidget(tr("Filmstrip"), parent)
+    , m_fixedModel(new ThumbnailListModel(cache, this))
+    , m_movingModel(new ThumbnailListModel(cache, this))
+{
+    setObjectName("filmstripDock");
+
+    m_fixedList = createStrip(m_fixedModel);
+    m_movingList = createStrip(m_movingModel);
+
+    QWidget *content = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(content);
+    layout->setContentsMargins(4, 4, 4, 4);
+    layout->addWidget(new QLabel(tr("Fixed"), content));
+    layout->addWidget(m_fixedList);
+    layout->addWidget(new QLabel(tr("Moving"), content));
+    layout->addWidget(m_movingList);
+    setWidget(content);
+
+    // clicked() is only emitted for user interaction, never for setCurrent*Index()
+    connect(m_fixedList, &QListView::clicked, this, [this](const QModelIndex &index) {
+        emit fixedIndexActivated(index.row());
+    });
+    connect(m_movingList, &QListView::clicked, this, [this](const QModelIndex &index) {
+        emit movingIndexActivated(index.row());
+    });
+}
+
+QListView *FilmstripDock::createStrip(ThumbnailListModel *model)
+{
+    const int side = ThumbnailCache::ThumbnailSize;
+
+    QListView *view = new QListView(this);
+    view->setModel(model);
+    view->setFlow(QListView::LeftToRight);
+    view->setWrapping(false);
+    view->setUniformItemSizes(true);
+    view->setLayoutMode(QListView::Batched);
+    view->setBatchSize(200);
+    view->setIconSize(QSize(side, side));
+    view->setSpacing(2);
+    view->setSelectionMode(QAbstractItemView::SingleSelection);
+    view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    view->setHorizontalScrollMode(QAbstractItemView::ScrollPerPixel);
+    view->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    view->setFixedHeight(side + view->horizontalScrollBar()->sizeHint().height() + 16);
+    return view;
+}
+
+void FilmstripDock::setFixedFiles(const QString &dir, const QStringList &files)
+{
+    m_fixedModel->setFiles(dir, files);
+}
+
+void FilmstripDock::setMovingFiles(const QString &dir, const QStringList &files)
+{
+    m_movingModel->setFiles(dir, files);
+}
+
+void FilmstripDock::setCurrentFixedIndex(int index)
+{
+    selectRow(m_fixedList, index);
+}
+
+void FilmstripDock::setCurrentMovingIndex(int index)
+{
+    selectRow(m_movingList, index);
+}
+
+void FilmstripDock::selectRow(QListView *view, int row)
+{
+    const QModelIndex index = view->model()->index(row, 0);
+    if (!index.isValid()) {
+        view->clearSelection();
+        return;
+    }
+    view->setCurrentIndex(index);
+    view->scrollTo(index, QAbstractItemView::PositionAtCenter);
+}
@@ -0,0 +1,44 @@
+#ifndef FILMSTRIPDOCK_H
+#define FILMSTRIPDOCK_H
+
+#include <QDockWidget>
+#include <QStringList>
+
+class QListView;
+class ThumbnailCache;
+class ThumbnailListModel;
+
+/**
+ * @brief Dock with one horizontal thumbnail strip per image directory.
+ *
+ * Both strips are list views with uniform item sizes, so layout and painting
+ * only touch the visible items and folders with tens of thousands of files
+ * stay responsive. Clicking a thumbnail reports its index; MainWindow loads it.
+ */
+class FilmstripDock : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit FilmstripDock(ThumbnailCache *cache, QWidget *parent = nullptr);
+
+    void setFixedFiles(const QString &dir, const QStringList &files);
+    void setMovingFiles(const QString &dir, const QStringList &files);
+    void setCurrentFixedIndex(int index);
+    void setCurrentMovingIndex(int index);
+
+signals:
+    void fixedIndexActivated(int index);
+    void movingIndexActivated(int index);
+
+private:
+    QListView *createStrip(ThumbnailListModel *model);
+    static void selectRow(QListView *view, int row);
+
+    ThumbnailListModel *m_fixedModel;
+    ThumbnailListModel *m_movingModel;
+    QListView *m_fixedList;
+    QListView *m_movingList;
+};
+
+#endif // FILMSTRIPDOCK_H
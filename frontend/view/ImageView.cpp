@@ -0,0 +1,88 @@
+#include "ImageView.h"
+#include "TiePointMarkerItem.h"
+
+#include <QLineF>
+#include <QPainter>
+
+namespace {
+
+// Screen-pixel geometry of the cursor crosshair (an unselected marker)
+constexpr qreal ArmLength = 10.0;
+constexpr qreal PenWidth = 2.0;
+constexpr qreal GapRadius = 3.0;
+constexpr qreal Opacity = 0.7;     // Tells it apart from placed points
+
+} // namespace
+
+ImageView::ImageView(QWidget *parent)
+    : QGraphicsView(parent)
+    , m_hasCursorMarker(false)
+{
+}
+
+void ImageView::setCursorMarker(const QPointF &scenePos, const QColor &color)
+{
+    if (m_hasCursorMarker && scenePos == m_cursorScenePos && color == m_cursorColor)
+        return;
+
+    // Repaint where it was and where it goes, nothing else
+    if (m_hasCursorMarker)
+        viewport()->update(cursorMarkerRect());
+    m_hasCursorMarker = true;
+    m_cursorScenePos = scenePos;
+    m_cursorColor = color;
+    viewport()->update(cursorMarkerRect());
+}
+
+void ImageView::clearCursorMarker()
+{
+    if (!m_hasCursorMarker)
+        return;
+    viewport()->update(cursorMarkerRect());
+    m_hasCursorMarker = false;
+}
+
+QRect ImageView::cursorMarkerRect() const
+{
+    // Arms plus the outline pen and antialiasing
+    const int extent = int(ArmLength + PenWidth + 4);
+    const QPoint center = mapFromScene(m_cursorScenePos);
+    return QRect(center.x() - extent, center.y() - extent, 2 * extent + 1, 2 * extent + 1);
+}
+
+void ImageView::drawForeground(QPainter *painter, const QRectF &rect)
+{
+    QGraphicsView::drawForeground(painter, rect);
+    if (!m_hasCursorMarker)
+        return;
+
+    const QPointF center = viewportTransform().map(m_cursorScenePos);
+    const QColor outline = TiePointMarkerItem::outlineColorFor(m_cursorColor);
+    const QLineF arms[] = {
+        QLineF(center.x() - ArmLength, center.y(), center.x() - GapRadius, center.y()),
+        QLineF(center.x() + GapRadius, center.y(), center.x() + ArmLength, center.y()),
+        QLineF(center.x(), center.y() - ArmLength, center.x(), center.y() - GapRadius),
+        QLineF(center.x(), center.y() + GapRadius, center.x(), center.y() + ArmLength),
+    };
+
+    painter->save();
+    painter->resetTransform();
+    painter->setRenderHint(QPainter::Antialiasing, true);
+    painter->setOpacity(Opacity);
+
+    QPen outlinePen(outline, PenWidth + 2.0);
+    outlinePen.setCapStyle(Qt::RoundCap);
+    painter->setPen(outlinePen);
+    painter->drawLines(arms, 4);
+    QPen mainPen(m_cursorColor, PenWidth);
+    mainPen.setCapStyle(Qt::RoundCap);
+    painter->setPen(mainPen);
+    painter->drawLines(arms, 4);
+
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(outline);
+    painter->drawEllipse(center, 3.0, 3.0);
+    painter->setBrush(m_cursorColor);
+    painter->drawEllipse(center, 2.0, 2.0);
+    painter->restore();
+}
@@ -0,0 +1,39 @@
+#ifndef IMAGEVIEW_H
+#define IMAGEVIEW_H
+
+#include <QGraphicsView>
+#include <QColor>
+#include <QPointF>
+
+/**
+ * @brief Image view that draws the add-point cursor crosshair as an overlay.
+ *
+ * The crosshair is painted in drawForeground() in device coordinates, so it
+ * is not a scene item: moving it never touches the scene or its index, and
+ * only the small viewport areas under its old and new positions are
+ * repainted. It has the same look as the tie point markers.
+ */
+class ImageView : public QGraphicsView
+{
+    Q_OBJECT
+
+public:
+    explicit ImageView(QWidget *parent = nullptr);
+
+    // Shows the crosshair at scenePos, or moves it there
+    void setCursorMarker(const QPointF &scenePos, const QColor &color);
+    void clearCursorMarker();
+    bool hasCursorMarker() const { return m_hasCursorMarker; }
+
+protected:
+    void drawForeground(QPainter *painter, const QRectF &rect) override;
+
+private:
+    QRect cursorMarkerRect() const;
+
+    bool m_hasCursorMarker;
+    QPointF m_cursorScenePos;
+    QColor m_cursorColor;
+};
+
+#endif // IMAGEVIEW_H
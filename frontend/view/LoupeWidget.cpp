@@ -0,0 +1,385 @@
+#include "LoupeWidget.h"
+#include "TiledImageItem.h"
+#include "model/PyramidFile.h"
+
+#include <QPainter>
+#include <QPaintEvent>
+#include <QtMath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RL_HAVE_SSE2
+#endif
+
+namespace {
+
+const QRgb Background = qRgb(48, 48, 48);
+constexpr int ZoomSteps[] = {4, 6, 8, 12, 16};
+
+// Source pixels and weights contributing to one output column or row
+struct Taps {
+    int index[4];
+    float weight[4];
+    bool inside;        // Within the image (outside shows the background)
+};
+
+// Catmull-Rom (a = -0.5): sharp, no ringing on flat areas, passes through samples
+void cubicWeights(float t, float *w)
+{
+    w[0] = ((-0.5f * t + 1.0f) * t - 0.5f) * t;
+    w[1] = (1.5f * t - 2.5f) * t * t + 1.0f;
+    w[2] = ((-1.5f * t + 2.0f) * t + 0.5f) * t;
+    w[3] = (0.5f * t - 0.5f) * t * t;
+}
+
+// Output pixel o (of count) is centered on source coordinate
+// center + (o + 0.5 - count / 2) / pixelsPerSource; the patch holds the
+// sampled image's pixels from origin on, at scale patch pixels per source pixel
+std::vector<Taps> computeTaps(int count, qreal center, qreal pixelsPerSource, int origin, qreal scale,
+                              int patchSize, int sourceSize, int tapCount)
+{
+    std::vector<Taps> taps(size_t(count));
+    for (int o = 0; o < count; ++o) {
+        Taps &tap = taps[size_t(o)];
+        const qreal s = center + (o + 0.5 - count / 2.0) / pixelsPerSource;
+        tap.inside = s >= 0 && s < sourceSize;
+
+        // Patch pixel centers sit at integer u
+        const qreal u = s * scale - origin - 0.5;
+        const int i0 = int(qFloor(u));
+        const float t = float(u - i0);
+        if (tapCount == 2) {
+            tap.index[0] = i0;
+            tap.index[1] = i0 + 1;
+            tap.weight[0] = 1.0f - t;
+            tap.weight[1] = t;
+        } else {
+            for (int k = 0; k < 4; ++k)
+                tap.index[k] = i0 - 1 + k;
+            cubicWeights(t, tap.weight);
+        }
+        // Edge pixels repeat beyond the patch
+        for (int k = 0; k < tapCount; ++k)
+            tap.index[k] = qBound(0, tap.index[k], patchSize - 1);
+    }
+    return taps;
+}
+
+#ifdef RL_HAVE_SSE2
+inline __m128 loadPixel(QRgb pixel)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i v = _mm_cvtsi32_si128(int(pixel));
+    v = _mm_unpacklo_epi8(v, zero);
+    v = _mm_unpacklo_epi16(v, zero);
+    return _mm_cvtepi32_ps(v);
+}
+
+inline QRgb storePixel(__m128 value)
+{
+    // Round, then saturate to [0, 255] (bicubic overshoots at edges)
+    __m128i v = _mm_cvtps_epi32(value);
+    v = _mm_packs_epi32(v, v);
+    v = _mm_packus_epi16(v, v);
+    return QRgb(_mm_cvtsi128_si32(v)) | 0xff000000u;
+}
+#endif
+
+// Separable resample of an opaque 32-bit patch into out: a horizontal pass
+// over every patch row into a float buffer, then a vertical pass per output
+// row. Each pixel's four channels are processed together in one SSE2 register.
+void resample(const QImage &patch, const std::vector<Taps> &columns, const std::vector<Taps> &rows,
+              int tapCount, QImage &out)
+{
+    const int outWidth = out.width();
+    const int patchHeight = patch.height();
+    std::vector<float> horizontal(size_t(patchHeight) * outWidth * 4);
+
+    for (int y = 0; y < patchHeight; ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(patch.constScanLine(y));
+        float *dst = horizontal.data() + size_t(y) * outWidth * 4;
+        for (int x = 0; x < outWidth; ++x) {
+            const Taps &tap = columns[size_t(x)];
+#ifdef RL_HAVE_SSE2
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < tapCount; ++k)
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(tap.weight[k]), loadPixel(line[tap.index[k]])));
+            _mm_storeu_ps(dst + x * 4, acc);
+#else
+            float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (int k = 0; k < tapCount; ++k) {
+                const QRgb pixel = line[tap.index[k]];
+                acc[0] += tap.weight[k] * qBlue(pixel);
+                acc[1] += tap.weight[k] * qGreen(pixel);
+                acc[2] += tap.weight[k] * qRed(pixel);
+                acc[3] += tap.weight[k] * qAlpha(pixel);
+            }
+            for (int c = 0; c < 4; ++c)
+                dst[x * 4 + c] = acc[c];
+#endif
+        }
+    }
+
+    for (int y = 0; y < out.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(out.scanLine(y));
+        const Taps &tap = rows[size_t(y)];
+        if (!tap.inside)
+            continue;
+        for (int x = 0; x < outWidth; ++x) {
+            if (!columns[size_t(x)].inside)
+                continue;
+#ifdef RL_HAVE_SSE2
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < tapCount; ++k) {
+                const float *src = horizontal.data() + (size_t(tap.index[k]) * outWidth + x) * 4;
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(tap.weight[k]), _mm_loadu_ps(src)));
+            }
+            line[x] = storePixel(acc);
+#else
+            float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (int k = 0; k < tapCount; ++k) {
+                const float *src = horizontal.data() + (size_t(tap.index[k]) * outWidth + x) * 4;
+                for (int c = 0; c < 4; ++c)
+                    acc[c] += tap.weight[k] * src[c];
+            }
+            auto channel = [&](int c) { return qBound(0, int(acc[c] + 0.5f), 255); };
+            line[x] = qRgb(channel(2), channel(1), channel(0));
+#endif
+        }
+    }
+}
+
+} // namespace
+
+LoupeWidget::LoupeWidget(QWidget *parent)
+    : QWidget(parent, Qt::ToolTip | Qt::FramelessWindowHint | Qt::WindowTransparentForInput)
+    , m_zoom(8)
+    , m_filter(Bicubic)
+    , m_crosshairColor(Qt::red)
+    , m_highBitDepth(false)
+{
+    setAttribute(Qt::WA_ShowWithoutActivating);
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setFixedSize(LoupeSize, LoupeSize);
+}
+
+void LoupeWidget::setZoom(int zoom)
+{
+    zoom = qBound(MinZoom, zoom, MaxZoom);
+    if (zoom == m_zoom)
+        return;
+    m_zoom = zoom;
+    update();
+}
+
+void LoupeWidget::stepZoom(int steps)
+{
+    const int count = int(sizeof(ZoomSteps) / sizeof(ZoomSteps[0]));
+    int index = 0;
+    while (index < count - 1 && ZoomSteps[index] < m_zoom)
+        ++index;
+    setZoom(ZoomSteps[qBound(0, index + steps, count - 1)]);
+}
+
+void LoupeWidget::setFilter(Filter filter)
+{
+    if (filter == m_filter)
+        return;
+    m_filter = filter;
+    update();
+}
+
+void LoupeWidget::setCrosshairColor(const QColor &color)
+{
+    if (color == m_crosshairColor)
+        return;
+    m_crosshairColor = color;
+    update();
+}
+
+void LoupeWidget::setSource(const TiledImageItem *item)
+{
+    if (!item || item->isNull()) {
+        m_handle = ImageHandle();
+        m_lut.reset();
+        return;
+    }
+
+    m_handle = item->handle();
+    const WindowLevel windowLevel = item->windowLevel();
+    const bool highBitDepth = item->isHighBitDepth();
+    if (windowLevel == m_windowLevel && highBitDepth == m_highBitDepth && (m_lut || windowLevel.isIdentity()))
+        return;
+
+    // Same mapping as the item's tiles
+    m_windowLevel = windowLevel;
+    m_highBitDepth = highBitDepth;
+    m_lut.reset();
+    if (!m_windowLevel.isIdentity())
+        m_lut.reset(new WindowLevelLut(m_windowLevel, m_highBitDepth));
+}
+
+void LoupeWidget::showAt(const QPointF &sourcePos, const QPointF &displayPos,
+                         const QPoint &globalCursor, const QRect &globalBounds)
+{
+    m_sourcePos = sourcePos;
+    m_displayPos = displayPos;
+
+    // Below right of the cursor, flipped where it would leave the view
+    const int offset = 24;
+    QPoint topLeft = globalCursor + QPoint(offset, offset);
+    if (topLeft.x() + width() > globalBounds.right())
+        topLeft.setX(globalCursor.x() - offset - width());
+    if (topLeft.y() + height() > globalBounds.bottom())
+        topLeft.setY(globalCursor.y() - offset - height());
+    if (topLeft != pos())
+        move(topLeft);
+
+    if (!isVisible())
+        show();
+    // Coalesced: several moves within one frame resample once
+    update();
+}
+
+QImage LoupeWidget::toDisplay(const QImage &native) const
+{
+    QImage mapped = m_lut ? m_lut->apply(native)
+                          : native.convertToFormat(native.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                                            : QImage::Format_RGB32);
+    if (!mapped.hasAlphaChannel())
+        return mapped;
+
+    // The kernel works on opaque pixels
+    QImage opaque(mapped.size(), QImage::Format_RGB32);
+    opaque.fill(Background);
+    QPainter painter(&opaque);
+    painter.drawImage(0, 0, mapped);
+    return opaque;
+}
+
+QImage LoupeWidget::displayPatch(const QRect &sourceRect, QPoint &origin, qreal &scale) const
+{
+    const QSharedPointer<const PyramidFile> pyramid = m_handle.pyramid();
+    if (m_handle.isPreview() && pyramid) {
+        // Full-resolution pixels straight from the mapped pyramid
+        const int tileSize = PyramidFile::TileSize;
+        QImage patch(sourceRect.size(), QImage::Format_RGB32);
+        patch.fill(Background);
+        QPainter painter(&patch);
+        for (int ty = sourceRect.top() / tileSize; ty <= sourceRect.bottom() / tileSize; ++ty) {
+            for (int tx = sourceRect.left() / tileSize; tx <= sourceRect.right() / tileSize; ++tx) {
+                const QImage tile = pyramid->tile(0, tx, ty);
+                if (tile.isNull())
+                    continue;
+                const QRect tileRect(tx * tileSize, ty * tileSize, tile.width(), tile.height());
+                const QRect part = tileRect.intersected(sourceRect);
+                painter.drawImage(part.topLeft() - sourceRect.topLeft(),
+                                  toDisplay(tile.copy(part.translated(-tileRect.topLeft()))));
+            }
+        }
+        origin = sourceRect.topLeft();
+        scale = 1.0;
+        return patch;
+    }
+
+    // The handle's image, which may be a downscaled preview
+    const QImage &image = m_handle.image();
+    scale = qreal(image.width()) / m_handle.width();
+    const QRect imageRect = QRectF(sourceRect.x() * scale, sourceRect.y() * scale,
+                                   sourceRect.width() * scale, sourceRect.height() * scale)
+                                .toAlignedRect().intersected(image.rect());
+    origin = imageRect.topLeft();
+    if (imageRect.isEmpty())
+        return QImage();
+    return toDisplay(image.copy(imageRect));
+}
+
+void LoupeWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    // Sample at device resolution
+    const qreal dpr = devicePixelRatioF();
+    QImage out(qRound(width() * dpr), qRound(height() * dpr), QImage::Format_RGB32);
+    out.fill(Background);
+    const qreal pixelsPerSource = m_zoom * dpr;
+
+    if (!m_handle.isNull()) {
+        // Visible source area plus the kernel's reach
+        const qreal halfWidth = out.width() / (2 * pixelsPerSource) + 3;
+        const qreal halfHeight = out.height() / (2 * pixelsPerSource) + 3;
+        const QRect sourceRect = QRectF(m_sourcePos.x() - halfWidth, m_sourcePos.y() - halfHeight,
+                                        2 * halfWidth, 2 * halfHeight)
+                                     .toAlignedRect().intersected(QRect(QPoint(0, 0), m_handle.size()));
+        if (!sourceRect.isEmpty()) {
+            QPoint origin;
+            qreal scale = 1.0;
+            const QImage patch = displayPatch(sourceRect, origin, scale);
+            if (!patch.isNull()) {
+                const int tapCount = m_filter == Bicubic ? 4 : 2;
+                const auto columns = computeTaps(out.width(), m_sourcePos.x(), pixelsPerSource, origin.x(),
+                                                 scale, patch.width(), m_handle.width(), tapCount);
+                const auto rows = computeTaps(out.height(), m_sourcePos.y(), pixelsPerSource, origin.y(),
+                                              scale, patch.height(), m_handle.height(), tapCount);
+                resample(patch, columns, rows, tapCount, out);
+            }
+        }
+    }
+    out.setDevicePixelRatio(dpr);
+
+    QPainter painter(this);
+    painter.drawImage(0, 0, out);
+
+    const QPointF center(width() / 2.0, height() / 2.0);
+
+    // Source pixel boundaries once they are large enough to tell apart
+    if (m_zoom >= 8 && !m_handle.isNull()) {
+        painter.setPen(QPen(QColor(255, 255, 255, 40), 0));
+        const qreal left = m_sourcePos.x() - center.x() / m_zoom;
+        const qreal top = m_sourcePos.y() - center.y() / m_zoom;
+        for (int k = int(qCeil(left)); k <= int(qFloor(left + width() / qreal(m_zoom))); ++k) {
+            const qreal x = (k - m_sourcePos.x()) * m_zoom + center.x();
+            painter.drawLine(QPointF(x, 0), QPointF(x, height()));
+        }
+        for (int k = int(qCeil(top)); k <= int(qFloor(top + height() / qreal(m_zoom))); ++k) {
+            const qreal y = (k - m_sourcePos.y()) * m_zoom + center.y();
+            painter.drawLine(QPointF(0, y), QPointF(width(), y));
+        }
+    }
+
+    // Thin crosshair at the exact cursor position; the center stays clear
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    const qreal gap = 4.0;
+    const qreal arm = 16.0;
+    const QLineF arms[] = {
+        QLineF(center.x() - arm, center.y(), center.x() - gap, center.y()),
+        QLineF(center.x() + gap, center.y(), center.x() + arm, center.y()),
+        QLineF(center.x(), center.y() - arm, center.x(), center.y() - gap),
+        QLineF(center.x(), center.y() + gap, center.x(), center.y() + arm),
+    };
+    painter.setPen(QPen(QColor(0, 0, 0, 160), 3.0));
+    painter.drawLines(arms, 4);
+    painter.setPen(QPen(m_crosshairColor, 1.0));
+    painter.drawLines(arms, 4);
+    painter.setRenderHint(QPainter::Antialiasing, false);
+
+    // Cursor position (as displayed elsewhere in the UI) and zoom
+    const QString text = QString("%1, %2  %3x")
+                             .arg(m_displayPos.x(), 0, 'f', 1)
+                             .arg(m_displayPos.y(), 0, 'f', 1)
+                             .arg(m_zoom);
+    QFont font = painter.font();
+    font.setPointSize(8);
+    painter.setFont(font);
+    const QRect textRect = rect().adjusted(4, 0, -4, -3);
+    painter.setPen(Qt::black);
+    painter.drawText(textRect.translated(1, 1), Qt::AlignLeft | Qt::AlignBottom, text);
+    painter.setPen(Qt::white);
+    painter.drawText(textRect, Qt::AlignLeft | Qt::AlignBottom, text);
+
+    painter.setPen(QPen(QColor(128, 128, 128), 1));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRect(rect().adjusted(0, 0, -1, -1));
+}
@@ -0,0 +1,438 @@
+#include "TiePointMarkerItem.h"
+
+#include <QFontMetricsF>
+#include <QHash>
+#include <QLineF>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QtMath>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+// Screen-pixel geometry of one marker (same look as the former item groups)
+constexpr qreal ArmLength = 10.0;
+constexpr qreal SelectedArmLength = 14.0;
+constexpr qreal PenWidth = 2.0;
+constexpr qreal SelectedPenWidth = 3.0;
+constexpr qreal GapRadius = 3.0;
+constexpr qreal SelectionRadius = 18.0;
+
+// Pens are identified by colour and selection state
+quint64 penKey(QRgb color, bool selected)
+{
+    return (quint64(color) << 1) | (selected ? 1 : 0);
+}
+
+void appendArms(QVector<QLineF> &lines, const QPointF &center, qreal armLength)
+{
+    lines.append(QLineF(center.x() - armLength, center.y(), center.x() - GapRadius, center.y()));
+    lines.append(QLineF(center.x() + GapRadius, center.y(), center.x() + armLength, center.y()));
+    lines.append(QLineF(center.x(), center.y() - armLength, center.x(), center.y() - GapRadius));
+    lines.append(QLineF(center.x(), center.y() + GapRadius, center.x(), center.y() + armLength));
+}
+
+void drawBatches(QPainter *painter, const QHash<quint64, QVector<QLineF>> &batches, qreal extraWidth)
+{
+    for (auto it = batches.constBegin(); it != batches.constEnd(); ++it) {
+        const bool selected = it.key() & 1;
+        QPen pen(QColor::fromRgba(QRgb(it.key() >> 1)),
+                 (selected ? SelectedPenWidth : PenWidth) + extraWidth);
+        pen.setCapStyle(Qt::RoundCap);
+        painter->setPen(pen);
+        painter->drawLines(it.value());
+    }
+}
+
+} // namespace
+
+TiePointMarkerItem::TiePointMarkerItem(QGraphicsItem *parent)
+    : QGraphicsObject(parent)
+    , m_hasBounds(false)
+    , m_showLabels(true)
+    , m_minScale(1.0)
+    , m_pendingMinScale(1.0)
+{
+    // exposedRect is needed to skip markers outside the visible area
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+    // Clicks are handled by the view's event filter, not by scene items
+    setAcceptedMouseButtons(Qt::NoButton);
+}
+
+void TiePointMarkerItem::setPalette(const QList<QColor> &colors)
+{
+    m_palette = colors;
+    update();
+}
+
+void TiePointMarkerItem::reset(int rowCount)
+{
+    prepareGeometryChange();
+    m_positions.fill(QPointF(), rowCount);
+    m_present.fill(false, rowCount);
+    m_selected.fill(false, rowCount);
+    m_selectedRows.clear();
+    m_grid.clear();
+    m_pointBounds = QRectF();
+    m_hasBounds = false;
+}
+
+void TiePointMarkerItem::insertRows(int row, int count)
+{
+    if (row < 0 || row > m_positions.size() || count <= 0)
+        return;
+    m_positions.insert(row, count, QPointF());
+    m_present.insert(row, count, false);
+    m_selected.insert(row, count, false);
+    for (auto it = std::lower_bound(m_selectedRows.begin(), m_selectedRows.end(), row);
+         it != m_selectedRows.end(); ++it)
+        *it += count;
+    m_grid.shiftRows(row, count);
+    // Labels and colours of the following rows shift
+    if (row < m_positions.size() - count)
+        update();
+}
+
+void TiePointMarkerItem::removeRows(int row, int count)
+{
+    if (row < 0 || count <= 0 || row + count > m_positions.size())
+        return;
+    for (int r = row; r < row + count; ++r) {
+        if (m_present[r])
+            m_grid.remove(r, m_positions[r]);
+    }
+    m_grid.shiftRows(row + count, -count);
+    m_positions.remove(row, count);
+    m_present.remove(row, count);
+    m_selected.remove(row, count);
+    auto first = std::lower_bound(m_selectedRows.begin(), m_selectedRows.end(), row);
+    auto last = std::lower_bound(first, m_selectedRows.end(), row + count);
+    for (auto it = last; it != m_selectedRows.end(); ++it)
+        *it -= count;
+    m_selectedRows.erase(first, last);
+    update();
+}
+
+void TiePointMarkerItem::setMarker(int row, const QPointF &pos)
+{
+    if (row < 0 || row >= m_positions.size())
+        return;
+    if (m_present[row] && m_positions[row] == pos)
+        return;
+    if (m_present[row]) {
+        m_grid.remove(row, m_positions[row]);
+        updateAround(m_positions[row]);
+    }
+    m_positions[row] = pos;
+    m_present[row] = true;
+    m_grid.insert(row, pos);
+    includeInBounds(pos);
+    updateAround(pos);
+}
+
+void TiePointMarkerItem::clearMarker(int row)
+{
+    if (row < 0 || row >= m_positions.size() || !m_present[row])
+        return;
+    m_present[row] = false;
+    m_grid.remove(row, m_positions[row]);
+    updateAround(m_positions[row]);
+}
+
+void TiePointMarkerItem::setSelected(int row, bool selected)
+{
+    if (row < 0 || row >= m_selected.size() || m_selected[row] == selected)
+        return;
+    m_selected[row] = selected;
+    auto it = std::lower_bound(m_selectedRows.begin(), m_selectedRows.end(), row);
+    if (selected)
+        m_selectedRows.insert(it, row);
+    else
+        m_selectedRows.erase(it);
+    if (m_present[row])
+        updateAround(m_positions[row]);
+}
+
+void TiePointMarkerItem::setSelected(const QVector<int> &rows, bool selected)
+{
+    if (rows.size() <= MaxRegionUpdates) {
+        for (int row : rows)
+            setSelected(row, selected);
+        return;
+    }
+    // Many rows: one full repaint instead of a region per marker, and the
+    // changed rows merged into the selected list in one pass
+    QVector<int> changed;
+    changed.reserve(rows.size());
+    for (int row : rows) {
+        if (row >= 0 && row < m_selected.size() && m_selected[row] != selected) {
+            m_selected[row] = selected;
+            changed.append(row);
+        }
+    }
+    if (changed.isEmpty())
+        return;
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    QVector<int> merged;
+    merged.reserve(selected ? m_selectedRows.size() + changed.size() : m_selectedRows.size());
+    if (selected) {
+        std::merge(m_selectedRows.begin(), m_selectedRows.end(), changed.begin(), changed.end(),
+                   std::back_inserter(merged));
+    } else {
+        std::set_difference(m_selectedRows.begin(), m_selectedRows.end(), changed.begin(), changed.end(),
+                            std::back_inserter(merged));
+    }
+    m_selectedRows.swap(merged);
+    update();
+}
+
+void TiePointMarkerItem::clearSelection()
+{
+    if (m_selectedRows.isEmpty())
+        return;
+    for (int row : std::as_const(m_selectedRows))
+        m_selected[row] = false;
+    m_selectedRows.clear();
+    update();
+}
+
+void TiePointMarkerItem::setShowLabels(bool show)
+{
+    if (m_showLabels == show)
+        return;
+    m_showLabels = show;
+    update();
+}
+
+int TiePointMarkerItem::markerAt(const QPointF &scenePos, qreal scale) const
+{
+    return m_grid.nearest(mapFromScene(scenePos), HitRadius / qMax(scale, 1e-6));
+}
+
+QVector<int> TiePointMarkerItem::markersIn(const QRectF &sceneRect) const
+{
+    return m_grid.rowsIn(mapRectFromScene(sceneRect));
+}
+
+QColor TiePointMarkerItem::colorOf(int row) const
+{
+    return m_palette.isEmpty() ? QColor(Qt::red) : m_palette[row % m_palette.size()];
+}
+
+void TiePointMarkerItem::includeInBounds(const QPointF &pos)
+{
+    // QRectF::united() ignores empty rects, so the bounds are grown by hand
+    QRectF bounds = m_hasBounds ? m_pointBounds : QRectF(pos, QSizeF(0, 0));
+    bounds.setLeft(qMin(bounds.left(), pos.x()));
+    bounds.setRight(qMax(bounds.right(), pos.x()));
+    bounds.setTop(qMin(bounds.top(), pos.y()));
+    bounds.setBottom(qMax(bounds.bottom(), pos.y()));
+    if (!m_hasBounds || bounds != m_pointBounds) {
+        prepareGeometryChange();
+        m_pointBounds = bounds;
+        m_hasBounds = true;
+    }
+}
+
+void TiePointMarkerItem::updateAround(const QPointF &pos)
+{
+    // A cluster badge sits anywhere in the point's screen bin
+    const qreal pad = (MarkerExtent + ClusterSize) / m_minScale;
+    update(QRectF(pos.x() - pad, pos.y() - pad, 2 * pad, 2 * pad));
+}
+
+QColor TiePointMarkerItem::outlineColorFor(const QColor &color)
+{
+    // Contrasting outline depending on the color brightness
+    const int brightness = (color.red() + color.green() + color.blue()) / 3;
+    return brightness > 128 ? QColor(Qt::black) : QColor(Qt::white);
+}
+
+QRectF TiePointMarkerItem::boundingRect() const
+{
+    if (!m_hasBounds)
+        return QRectF();
+    const qreal pad = MarkerExtent / m_minScale;
+    return m_pointBounds.adjusted(-pad, -pad, pad, pad);
+}
+
+void TiePointMarkerItem::applyMinScale()
+{
+    if (m_pendingMinScale >= m_minScale)
+        return;
+    prepareGeometryChange();
+    m_minScale = m_pendingMinScale;
+}
+
+void TiePointMarkerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+    if (!m_hasBounds)
+        return;
+
+    const QTransform transform = painter->worldTransform();
+    const qreal scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(transform);
+    if (scale > 0 && scale < m_pendingMinScale) {
+        // Geometry must not change during paint; the repaint follows
+        m_pendingMinScale = scale;
+        QMetaObject::invokeMethod(this, &TiePointMarkerItem::applyMinScale, Qt::QueuedConnection);
+    }
+
+    // Markers reaching into the exposed area
+    const qreal pad = MarkerExtent / qMax(scale, 1e-6);
+    const QRectF area = option->exposedRect.adjusted(-pad, -pad, pad, pad);
+
+    // Markers have a fixed screen size: everything is binned and drawn in
+    // device coordinates
+    QHash<quint64, Cluster> bins;
+    auto addToBin = [&](const QPointF &center, int count, int row) {
+        Cluster &bin = bins[binKey(center)];
+        bin.sum += center * count;
+        bin.count += count;
+        bin.row = row;
+    };
+
+    QVector<int> rows;
+    if (scale * m_grid.cellSize() < ClusterSize) {
+        // Zoomed out: grid cells are smaller than a bin, so their summaries
+        // suffice and the cost is bounded by the occupied cells, not points
+        for (const PointGridIndex::CellSummary &cell : m_grid.cellsIn(area))
+            addToBin(transform.map(cell.centroid), cell.count, cell.row);
+    } else {
+        rows = m_grid.rowsIn(area);
+        // Still too many to tell apart: bin the points themselves
+        if (rows.size() > MaxIndividualMarkers) {
+            for (int row : std::as_const(rows))
+                addToBin(transform.map(m_positions[row]), 1, row);
+            rows.clear();
+        }
+    }
+
+    // A bin holding a single point is drawn as that point's marker
+    QVector<Cluster> clusters;
+    for (const Cluster &bin : std::as_const(bins)) {
+        if (bin.count == 1)
+            rows.append(bin.row);
+        else
+            clusters.append(bin);
+    }
+
+    // Selected markers stay visible inside clusters (only the selected rows are visited)
+    if (!clusters.isEmpty()) {
+        for (int row : std::as_const(m_selectedRows)) {
+            if (m_present[row] && area.contains(m_positions[row]))
+                rows.append(row);
+        }
+    }
+    if (rows.isEmpty() && clusters.isEmpty())
+        return;
+
+    // Lower rows first, so later points are drawn on top as before
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    QVector<QPointF> centers;
+    centers.reserve(rows.size());
+    for (int row : std::as_const(rows))
+        centers.append(transform.map(m_positions[row]));
+
+    painter->save();
+    painter->resetTransform();
+    drawClusters(painter, clusters);
+    drawMarkers(painter, rows, centers);
+    painter->restore();
+}
+
+quint64 TiePointMarkerItem::binKey(const QPointF &devicePos)
+{
+    const int bx = int(qFloor(devicePos.x() / ClusterSize));
+    const int by = int(qFloor(devicePos.y() / ClusterSize));
+    return (quint64(quint32(bx)) << 32) | quint32(by);
+}
+
+void TiePointMarkerItem::drawClusters(QPainter *painter, const QVector<Cluster> &clusters)
+{
+    if (clusters.isEmpty())
+        return;
+
+    QFont font = painter->font();
+    font.setPointSize(8);
+    font.setBold(true);
+    painter->setFont(font);
+
+    // Count badges; the radius grows with the number of digits
+    const QFontMetricsF metrics(font);
+    for (const Cluster &cluster : clusters) {
+        const QPointF center = cluster.sum / cluster.count;
+        const QString text = QString::number(cluster.count);
+        const qreal radius = qMax<qreal>(9.0, metrics.horizontalAdvance(text) / 2 + 5);
+        painter->setPen(QPen(Qt::white, 1.5));
+        painter->setBrush(QColor(0, 90, 170, 200));
+        painter->drawEllipse(center, radius, radius);
+        painter->setPen(Qt::white);
+        painter->drawText(QRectF(center.x() - radius, center.y() - radius, 2 * radius, 2 * radius),
+                          Qt::AlignCenter, text);
+    }
+}
+
+void TiePointMarkerItem::drawMarkers(QPainter *painter, const QVector<int> &rows,
+                                     const QVector<QPointF> &centers) const
+{
+    if (rows.isEmpty())
+        return;
+    painter->setBrush(Qt::NoBrush);
+
+    // Selection circles behind everything
+    for (int k = 0; k < rows.size(); ++k) {
+        const int i = rows[k];
+        if (!m_selected[i])
+            continue;
+        painter->setPen(QPen(outlineColorFor(colorOf(i)), 2.0, Qt::DashLine));
+        painter->drawEllipse(centers[k], SelectionRadius, SelectionRadius);
+    }
+
+    // Arms: all outlines first, then the colored lines, one drawLines() per pen
+    QHash<quint64, QVector<QLineF>> outlineBatches;
+    QHash<quint64, QVector<QLineF>> colorBatches;
+    for (int k = 0; k < rows.size(); ++k) {
+        const int i = rows[k];
+        const bool selected = m_selected[i];
+        const qreal armLength = selected ? SelectedArmLength : ArmLength;
+        const QColor color = colorOf(i);
+        appendArms(outlineBatches[penKey(outlineColorFor(color).rgba(), selected)], centers[k], armLength);
+        appendArms(colorBatches[penKey(color.rgba(), selected)], centers[k], armLength);
+    }
+    drawBatches(painter, outlineBatches, 2.0);
+    drawBatches(painter, colorBatches, 0.0);
+
+    // Center dots
+    painter->setPen(Qt::NoPen);
+    for (int k = 0; k < rows.size(); ++k) {
+        const QColor color = colorOf(rows[k]);
+        painter->setBrush(outlineColorFor(color));
+        painter->drawEllipse(centers[k], 3.0, 3.0);
+        painter->setBrush(color);
+        painter->drawEllipse(centers[k], 2.0, 2.0);
+    }
+
+    // Pair numbers to the upper right, over a 1px offset outline
+    if (m_showLabels) {
+        QFont font = painter->font();
+        font.setPointSize(9);
+        font.setBold(true);
+        painter->setFont(font);
+        const qreal ascent = QFontMetricsF(font).ascent();
+        for (int k = 0; k < rows.size(); ++k) {
+            const int i = rows[k];
+            const qreal armLength = m_selected[i] ? SelectedArmLength : ArmLength;
+            const QColor color = colorOf(i);
+            const QString text = QString::number(i + 1);
+            const QPointF baseline = centers[k] + QPointF(armLength + 3, -armLength + ascent);
+            painter->setPen(outlineColorFor(color));
+            painter->drawText(baseline - QPointF(1, 1), text);
+            painter->setPen(color);
+            painter->drawText(baseline, text);
+        }
+    }
+}
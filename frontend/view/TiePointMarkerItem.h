@@ -0,0 +1,123 @@
+#ifndef TIEPOINTMARKERITEM_H
+#define TIEPOINTMARKERITEM_H
+
+#include <QGraphicsObject>
+#include <QColor>
+#include <QList>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+#include "model/PointGridIndex.h"
+
+/**
+ * @brief One scene item that draws every tie point marker of a view.
+ *
+ * Replaces a QGraphicsItemGroup of a dozen line, ellipse and text items per
+ * point. Markers are stored per tie point table row in flat arrays (position,
+ * presence, selection) and drawn in a single paint() call; the arms of all
+ * markers sharing a pen go out in one drawLines(). Markers outside the
+ * exposed rect are skipped, so panning cost depends on what is visible, not
+ * on the total.
+ *
+ * The arrays mirror the model's rows: insertRows()/removeRows() follow row
+ * insertions and removals, setMarker()/clearMarker()/setSelected() update a
+ * single row and repaint only around it. Colours and labels derive from the
+ * row number, so rows shifting after an insert or removal need no update.
+ *
+ * A PointGridIndex over the present markers answers hit-tests, rubber-band
+ * queries and the visible-marker lookup in paint() without scanning every
+ * row.
+ *
+ * Markers keep a fixed screen size (like ItemIgnoresTransformations): they
+ * are drawn in device coordinates, and hit-testing takes the view scale into
+ * account. Item coordinates are scene (image pixel) coordinates.
+ *
+ * Level of detail: when zoomed out far enough that grid cells are smaller
+ * than ClusterSize on screen, markers are aggregated per screen bin from the
+ * grid's cell summaries and drawn as count badges, so paint cost no longer
+ * depends on the number of points. A bin with a single point, and selected
+ * points, still get their crosshair; zooming in splits the badges until
+ * every point is drawn individually. Closer in, more than
+ * MaxIndividualMarkers visible points are binned the same way.
+ */
+class TiePointMarkerItem : public QGraphicsObject
+{
+    Q_OBJECT
+
+public:
+    // Screen-pixel sizes
+    static constexpr qreal HitRadius = 10.0;
+    static constexpr qreal MarkerExtent = 64.0;  // Furthest a marker reaches, label included
+    static constexpr qreal ClusterSize = 40.0;   // Screen bin for level-of-detail clusters
+    static constexpr int MaxIndividualMarkers = 2000;
+    // Above this many rows, a selection change repaints the whole item
+    static constexpr int MaxRegionUpdates = 256;
+
+    explicit TiePointMarkerItem(QGraphicsItem *parent = nullptr);
+
+    // Row r is drawn in palette[r % size] and labelled r + 1
+    void setPalette(const QList<QColor> &colors);
+
+    // All rows, without markers
+    void reset(int rowCount);
+    void insertRows(int row, int count);
+    void removeRows(int row, int count);
+    int rowCount() const { return m_positions.size(); }
+
+    void setMarker(int row, const QPointF &pos);
+    void clearMarker(int row);      // Row without a point on this side
+    void setSelected(int row, bool selected);
+    // Many rows at once, e.g. a table selection change
+    void setSelected(const QVector<int> &rows, bool selected);
+    void clearSelection();
+
+    void setShowLabels(bool show);
+    bool showLabels() const { return m_showLabels; }
+
+    // Row of the marker nearest to scenePos within HitRadius, or -1
+    // (scale is the view's level of detail, i.e. screen pixels per scene unit)
+    int markerAt(const QPointF &scenePos, qreal scale) const;
+    // Rows of the markers inside sceneRect
+    QVector<int> markersIn(const QRectF &sceneRect) const;
+
+    static QColor outlineColorFor(const QColor &color);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+               QWidget *widget = nullptr) override;
+
+private:
+    struct Cluster {
+        QPointF sum;        // Of device positions, weighted by count
+        int count = 0;
+        int row = -1;       // Of the last point added; the point when count == 1
+    };
+
+    static quint64 binKey(const QPointF &devicePos);
+    static void drawClusters(QPainter *painter, const QVector<Cluster> &clusters);
+    void drawMarkers(QPainter *painter, const QVector<int> &rows, const QVector<QPointF> &centers) const;
+    QColor colorOf(int row) const;
+    void includeInBounds(const QPointF &pos);
+    void updateAround(const QPointF &pos);
+    void applyMinScale();
+
+    QVector<QPointF> m_positions;
+    QVector<bool> m_present;
+    QVector<bool> m_selected;
+    QVector<int> m_selectedRows;    // Rows with m_selected set, ascending
+    QList<QColor> m_palette;
+    PointGridIndex m_grid;      // Present markers only
+
+    // Of the positions only; grows with new points and is reset by reset()
+    // (a removed point may leave it larger than needed, which is harmless)
+    QRectF m_pointBounds;
+    bool m_hasBounds;
+    bool m_showLabels;
+
+    // The bounding rect is padded by MarkerExtent at the smallest scale seen
+    // so far; a smaller one found while painting is applied asynchronously
+    qreal m_minScale;
+    qreal m_pendingMinScale;
+};
+
+#endif // TIEPOINTMARKERITEM_H
@@ -0,0 +1,498 @@
+#include "TiledImageItem.h"
+
+#include <QDebug>
+#include <QFutureWatcher>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtMath>
+
+namespace {
+
+QSize halfSize(const QSize &size)
+{
+    return QSize(qMax(1, (size.width() + 1) / 2), qMax(1, (size.height() + 1) / 2));
+}
+
+// Native pixels -> paint-ready 32-bit, through the window/level if one is set
+QImage toTileFormat(const QImage &image, const QSharedPointer<const WindowLevelLut> &lut)
+{
+    if (lut)
+        return lut->apply(image);
+    const QImage::Format format = image.hasAlphaChannel()
+        ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+    return image.convertToFormat(format);
+}
+
+} // namespace
+
+TiledImageItem::TiledImageItem(QGraphicsItem *parent)
+    : QGraphicsObject(parent)
+    , m_baseLevel(0)
+    , m_maxLevel(0)
+    , m_levelPending(false)
+    , m_regionDecodable(false)
+    , m_generation(0)
+    , m_tileGeneration(new QAtomicInteger<quint64>(0))
+{
+    // exposedRect is needed to restrict painting to visible tiles
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+    setCacheMode(QGraphicsItem::NoCache);
+    setTileCacheBudget(qint64(256) * 1024 * 1024);
+}
+
+TiledImageItem::~TiledImageItem()
+{
+}
+
+void TiledImageItem::setImage(const ImageHandle &handle)
+{
+    prepareGeometryChange();
+
+    ++m_generation;
+    m_handle = handle;
+    m_sourceSize = handle.isNull() ? QSize() : handle.size();
+    m_regionDecodable = handle.isRegionDecodable();
+    m_pyramid = handle.pyramid();
+    m_levels.clear();
+    m_tiles.clear();
+    invalidateTiles();
+    m_levelPending = false;
+    m_baseLevel = 0;
+    m_maxLevel = 0;
+
+    if (!m_handle.isNull()) {
+        const QImage &image = m_handle.image();
+
+        // Coarsest level is the first one that fits into a single tile
+        QSize size = m_sourceSize;
+        while (size.width() > TileSize || size.height() > TileSize) {
+            size = halfSize(size);
+            ++m_maxLevel;
+        }
+        m_levels.resize(m_maxLevel + 1);
+
+        int base = levelOfSize(image.size());
+        QImage baseImage = image;
+        if (base < 0) {
+            // Not one of our levels: resample onto the nearest one
+            base = qBound(0, qRound(std::log2(qreal(m_sourceSize.width()) / image.width())), m_maxLevel);
+            qWarning() << "TiledImageItem: image size" << image.size()
+                       << "is not a pyramid level of" << m_sourceSize;
+            baseImage = image.scaled(levelSize(base), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        }
+        m_baseLevel = base;
+        m_levels[base] = baseImage;
+
+        // Only usable if its tiles line up with ours
+        if (m_pyramid && (PyramidFile::TileSize != TileSize || m_pyramid->sourceSize() != m_sourceSize
+                          || m_pyramid->levelCount() != m_maxLevel + 1)) {
+            qWarning() << "TiledImageItem: ignoring pyramid with mismatched geometry";
+            m_pyramid.reset();
+            m_regionDecodable = false;
+        }
+    }
+
+    // 8-bit images start unmapped; high-bit-depth data rarely spans its whole
+    // code range, so start from the actual sample range instead
+    m_dataRange = WindowLevel::fromPercentiles(m_levels.value(m_baseLevel), 0.0, 1.0);
+    m_windowLevel = isHighBitDepth() ? m_dataRange : WindowLevel();
+    m_lut.reset();
+    if (!m_windowLevel.isIdentity())
+        m_lut.reset(new WindowLevelLut(m_windowLevel, isHighBitDepth()));
+
+    update();
+}
+
+void TiledImageItem::setWindowLevel(const WindowLevel &windowLevel)
+{
+    if (windowLevel == m_windowLevel)
+        return;
+
+    m_windowLevel = windowLevel;
+    m_lut.reset();
+    if (!m_windowLevel.isIdentity())
+        m_lut.reset(new WindowLevelLut(m_windowLevel, isHighBitDepth()));
+
+    // Cached tiles stay on screen until their re-mapped versions arrive;
+    // the native levels are untouched
+    invalidateTiles();
+    update();
+}
+
+bool TiledImageItem::isHighBitDepth() const
+{
+    return WindowLevel::isHighBitDepth(m_handle.image().format());
+}
+
+void TiledImageItem::invalidateTiles()
+{
+    m_tileGeneration->fetchAndAddOrdered(1);
+    m_pendingTiles.clear();
+}
+
+void TiledImageItem::refineImage(const ImageHandle &handle)
+{
+    const QImage &image = handle.image();
+    const int level = levelOfSize(image.size());
+    if (handle.path() != m_handle.path() || image.isNull() || level < 0 || level >= m_baseLevel)
+        return;
+
+    // Coarser levels and cached tiles stay valid: same source, finer pixels
+    m_handle = handle;
+    m_levels[level] = image;
+    m_baseLevel = level;
+    m_regionDecodable = handle.isRegionDecodable();
+    update();
+}
+
+void TiledImageItem::setTileCacheBudget(qint64 bytes)
+{
+    m_tiles.setMaxCost(qsizetype(qMax<qint64>(1024, bytes) / 1024));
+}
+
+QRectF TiledImageItem::boundingRect() const
+{
+    return QRectF(QPointF(0, 0), QSizeF(m_sourceSize));
+}
+
+// ============================================================================
+// Painting
+// ============================================================================
+
+void TiledImageItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+
+    if (m_handle.isNull())
+        return;
+
+    const qreal scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    int level = levelForScale(scale);
+
+    // Finer than the pixels we hold is only reachable through region reads
+    if (level < m_baseLevel && !m_regionDecodable)
+        level = m_baseLevel;
+
+    // Levels are built one after another on a worker; ask for the next one
+    // (a cached pyramid already has them all)
+    if (level > m_baseLevel && !isLevelBuilt(level) && !m_pyramid)
+        requestLevel(level);
+
+    const QRectF exposed = option->exposedRect.intersected(boundingRect());
+    if (exposed.isEmpty())
+        return;
+
+    const QSize size = levelSize(level);
+    const qreal sx = qreal(m_sourceSize.width()) / size.width();
+    const qreal sy = qreal(m_sourceSize.height()) / size.height();
+    const int cols = (size.width() + TileSize - 1) / TileSize;
+    const int rows = (size.height() + TileSize - 1) / TileSize;
+
+    const int tx0 = qBound(0, int(qFloor(exposed.left() / sx / TileSize)), cols - 1);
+    const int tx1 = qBound(0, int(qFloor(exposed.right() / sx / TileSize)), cols - 1);
+    const int ty0 = qBound(0, int(qFloor(exposed.top() / sy / TileSize)), rows - 1);
+    const int ty1 = qBound(0, int(qFloor(exposed.bottom() / sy / TileSize)), rows - 1);
+
+    // Paint-ready levels need no tile copies: draw the shared pixels directly
+    if (isLevelBuilt(level) && isPaintReady(m_levels.at(level))) {
+        const QRectF source(exposed.left() / sx, exposed.top() / sy, exposed.width() / sx, exposed.height() / sy);
+        painter->drawImage(exposed, m_levels.at(level), source);
+        return;
+    }
+
+    const quint64 tileGeneration = m_tileGeneration->loadAcquire();
+
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            Tile *tile = m_tiles.object(tileKey(level, tx, ty));
+            if (tile) {
+                painter->drawPixmap(tileSceneRect(level, tx, ty), tile->pixmap, QRectF(tile->pixmap.rect()));
+                if (tile->generation == tileGeneration)
+                    continue;
+                // Outdated mapping: keep it on screen, fetch the new one
+            }
+
+            if (isLevelBuilt(level))
+                requestTile(level, tx, ty);
+            else if (m_pyramid)
+                requestPyramidTile(level, tx, ty);
+            else if (level < m_baseLevel)
+                requestRegionTile(level, tx, ty);
+            if (!tile)
+                drawFallback(painter, level, tx, ty);
+        }
+    }
+}
+
+bool TiledImageItem::drawFallback(QPainter *painter, int level, int tx, int ty)
+{
+    const QRectF target = tileSceneRect(level, tx, ty);
+
+    // Stretch whatever coarser tiles are already cached over the missing one
+    for (int coarse = level + 1; coarse <= m_maxLevel; ++coarse) {
+        const QSize size = levelSize(coarse);
+        const qreal sx = qreal(m_sourceSize.width()) / size.width();
+        const qreal sy = qreal(m_sourceSize.height()) / size.height();
+        const int cols = (size.width() + TileSize - 1) / TileSize;
+        const int rows = (size.height() + TileSize - 1) / TileSize;
+
+        const int cx0 = qBound(0, int(qFloor(target.left() / sx / TileSize)), cols - 1);
+        const int cx1 = qBound(0, int(qFloor(target.right() / sx / TileSize)), cols - 1);
+        const int cy0 = qBound(0, int(qFloor(target.top() / sy / TileSize)), rows - 1);
+        const int cy1 = qBound(0, int(qFloor(target.bottom() / sy / TileSize)), rows - 1);
+
+        bool complete = true;
+        for (int cy = cy0; cy <= cy1 && complete; ++cy) {
+            for (int cx = cx0; cx <= cx1 && complete; ++cx) {
+                complete = m_tiles.contains(tileKey(coarse, cx, cy));
+            }
+        }
+        if (!complete)
+            continue;
+
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                Tile *tile = m_tiles.object(tileKey(coarse, cx, cy));
+                const QRectF tileRect = tileSceneRect(coarse, cx, cy);
+                const QRectF part = tileRect.intersected(target);
+                if (!tile || part.isEmpty())
+                    continue;
+                const QRectF source((part.left() - tileRect.left()) / sx,
+                                    (part.top() - tileRect.top()) / sy,
+                                    part.width() / sx,
+                                    part.height() / sy);
+                painter->drawPixmap(part, tile->pixmap, source);
+            }
+        }
+        return true;
+    }
+
+    // Nothing cached yet (first paint, or just zoomed in): sample the finest
+    // built level that is no larger than the tile on screen. Zoomed out before
+    // the coarser levels exist, scale down the nearest finer one instead (down
+    // to m_baseLevel); the cost follows the target pixels, not the source
+    int built = -1;
+    for (int candidate = qMax(level, m_baseLevel); candidate <= m_maxLevel && built < 0; ++candidate) {
+        if (isLevelBuilt(candidate) && isPaintReady(m_levels.at(candidate)))
+            built = candidate;
+    }
+    for (int candidate = level - 1; candidate >= m_baseLevel && built < 0; --candidate) {
+        if (isLevelBuilt(candidate) && isPaintReady(m_levels.at(candidate)))
+            built = candidate;
+    }
+    if (built < 0)
+        return false;
+
+    const QSize size = levelSize(built);
+    const qreal sx = qreal(m_sourceSize.width()) / size.width();
+    const qreal sy = qreal(m_sourceSize.height()) / size.height();
+    const QRectF source(target.left() / sx, target.top() / sy, target.width() / sx, target.height() / sy);
+    painter->drawImage(target, m_levels.at(built), source);
+    return true;
+}
+
+// ============================================================================
+// Pyramid Geometry
+// ============================================================================
+
+quint64 TiledImageItem::tileKey(int level, int tx, int ty)
+{
+    return (quint64(level) << 48) | (quint64(quint32(ty) & 0xFFFFFF) << 24) | quint64(quint32(tx) & 0xFFFFFF);
+}
+
+bool TiledImageItem::isPaintReady(const QImage &image) const
+{
+    // Any window/level other than identity needs mapped tiles
+    return !m_lut && (image.format() == QImage::Format_RGB32
+                      || image.format() == QImage::Format_ARGB32_Premultiplied);
+}
+
+bool TiledImageItem::isLevelBuilt(int level) const
+{
+    return level >= 0 && level < m_levels.size() && !m_levels.at(level).isNull();
+}
+
+int TiledImageItem::levelForScale(qreal scale) const
+{
+    if (scale >= 1.0 || scale <= 0.0)
+        return 0;
+    // Finest level whose resolution is still at least the screen resolution
+    const int level = int(qFloor(std::log2(1.0 / scale)));
+    return qBound(0, level, m_maxLevel);
+}
+
+int TiledImageItem::levelOfSize(const QSize &size) const
+{
+    QSize levelSz = m_sourceSize;
+    for (int level = 0; level <= m_maxLevel; ++level) {
+        if (levelSz == size)
+            return level;
+        levelSz = halfSize(levelSz);
+    }
+    return -1;
+}
+
+QSize TiledImageItem::levelSize(int level) const
+{
+    QSize size = m_sourceSize;
+    for (int l = 0; l < level; ++l)
+        size = halfSize(size);
+    return size;
+}
+
+QRectF TiledImageItem::tileSceneRect(int level, int tx, int ty) const
+{
+    const QSize size = levelSize(level);
+    const qreal sx = qreal(m_sourceSize.width()) / size.width();
+    const qreal sy = qreal(m_sourceSize.height()) / size.height();
+
+    const int x = tx * TileSize;
+    const int y = ty * TileSize;
+    const int w = qMin(TileSize, size.width() - x);
+    const int h = qMin(TileSize, size.height() - y);
+
+    return QRectF(x * sx, y * sy, w * sx, h * sy);
+}
+
+// ============================================================================
+// Background Work
+// ============================================================================
+
+void TiledImageItem::requestLevel(int level)
+{
+    if (m_levelPending)
+        return;
+
+    // Build the first missing level between the base and the one wanted
+    int next = m_baseLevel + 1;
+    while (next <= level && isLevelBuilt(next))
+        ++next;
+    if (next > level || next > m_maxLevel)
+        return;
+
+    m_levelPending = true;
+    const quint64 generation = m_generation;
+    const QImage previous = m_levels.at(next - 1);
+
+    auto *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, generation, next]() {
+        watcher->deleteLater();
+        if (generation != m_generation)
+            return;
+        m_levelPending = false;
+        m_levels[next] = watcher->result();
+        update();
+    });
+
+    watcher->setFuture(QtConcurrent::run(QThreadPool::globalInstance(), [previous]() -> QImage {
+        return previous.scaled(halfSize(previous.size()), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }));
+}
+
+void TiledImageItem::requestTile(int level, int tx, int ty)
+{
+    const quint64 key = tileKey(level, tx, ty);
+    if (m_pendingTiles.contains(key))
+        return;
+    m_pendingTiles.insert(key);
+
+    QSharedPointer<QAtomicInteger<quint64>> latest = m_tileGeneration;
+    const quint64 tileGeneration = latest->loadAcquire();
+    const QSharedPointer<const WindowLevelLut> lut = m_lut;
+    const QImage levelImage = m_levels.at(level);
+    const QRect rect(tx * TileSize, ty * TileSize, TileSize, TileSize);
+
+    auto *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, tileGeneration, key, level, tx, ty]() {
+        watcher->deleteLater();
+        insertTile(key, tileGeneration, watcher->result(), level, tx, ty);
+    });
+
+    watcher->setFuture(QtConcurrent::run(QThreadPool::globalInstance(),
+                                         [levelImage, rect, lut, latest, tileGeneration]() -> QImage {
+        // Contrast moved on (or a new image) while queued
+        if (latest->loadAcquire() != tileGeneration)
+            return QImage();
+        return toTileFormat(levelImage.copy(rect.intersected(levelImage.rect())), lut);
+    }));
+}
+
+void TiledImageItem::requestRegionTile(int level, int tx, int ty)
+{
+    const quint64 key = tileKey(level, tx, ty);
+    if (m_pendingTiles.contains(key))
+        return;
+    m_pendingTiles.insert(key);
+
+    QSharedPointer<QAtomicInteger<quint64>> latest = m_tileGeneration;
+    const quint64 tileGeneration = latest->loadAcquire();
+    const QSharedPointer<const WindowLevelLut> lut = m_lut;
+    const ImageHandle handle = m_handle;
+    const QSize size = levelSize(level);
+    const QSize tileSize(qMin(TileSize, size.width() - tx * TileSize),
+                         qMin(TileSize, size.height() - ty * TileSize));
+    const QRect sourceRect = tileSceneRect(level, tx, ty).toAlignedRect()
+        .intersected(QRect(QPoint(0, 0), m_sourceSize));
+
+    auto *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, tileGeneration, key, level, tx, ty]() {
+        watcher->deleteLater();
+        insertTile(key, tileGeneration, watcher->result(), level, tx, ty);
+    });
+
+    watcher->setFuture(QtConcurrent::run(QThreadPool::globalInstance(),
+                                         [handle, sourceRect, tileSize, lut, latest, tileGeneration]() -> QImage {
+        if (latest->loadAcquire() != tileGeneration)
+            return QImage();
+        QImage region = handle.readRegion(sourceRect, tileSize);
+        if (region.isNull())
+            return QImage();
+        if (region.size() != tileSize)
+            region = region.scaled(tileSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        return toTileFormat(region, lut);
+    }));
+}
+
+void TiledImageItem::requestPyramidTile(int level, int tx, int ty)
+{
+    const quint64 key = tileKey(level, tx, ty);
+    if (m_pendingTiles.contains(key))
+        return;
+    m_pendingTiles.insert(key);
+
+    QSharedPointer<QAtomicInteger<quint64>> latest = m_tileGeneration;
+    const quint64 tileGeneration = latest->loadAcquire();
+    const QSharedPointer<const WindowLevelLut> lut = m_lut;
+    const QSharedPointer<const PyramidFile> pyramid = m_pyramid;
+
+    auto *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, tileGeneration, key, level, tx, ty]() {
+        watcher->deleteLater();
+        insertTile(key, tileGeneration, watcher->result(), level, tx, ty);
+    });
+
+    // The page faults for the tile happen here, off the GUI thread
+    watcher->setFuture(QtConcurrent::run(QThreadPool::globalInstance(),
+                                         [pyramid, level, tx, ty, lut, latest, tileGeneration]() -> QImage {
+        if (latest->loadAcquire() != tileGeneration)
+            return QImage();
+        return toTileFormat(pyramid->tile(level, tx, ty), lut);
+    }));
+}
+
+void TiledImageItem::insertTile(quint64 key, quint64 tileGeneration, const QImage &tileImage, int level, int tx, int ty)
+{
+    // Stale: the pending set was already reset when the generation moved
+    if (tileGeneration != m_tileGeneration->loadAcquire())
+        return;
+
+    m_pendingTiles.remove(key);
+    if (tileImage.isNull())
+        return;
+
+    Tile *tile = new Tile{QPixmap::fromImage(tileImage), tileGeneration};
+    m_tiles.insert(key, tile, qsizetype(qMax<qint64>(1, qint64(tileImage.sizeInBytes()) / 1024)));
+    update(tileSceneRect(level, tx, ty));
+}
@@ -0,0 +1,122 @@
+#ifndef TILEDIMAGEITEM_H
+#define TILEDIMAGEITEM_H
+
+#include <QGraphicsObject>
+#include <QAtomicInteger>
+#include <QCache>
+#include <QImage>
+#include <QPixmap>
+#include <QSet>
+#include <QSharedPointer>
+#include <QVector>
+#include "model/ImageHandle.h"
+#include "model/PyramidFile.h"
+#include "WindowLevel.h"
+
+/**
+ * @brief Scene item that renders a large image as a lazily built tile pyramid.
+ *
+ * Replaces a single full-size QGraphicsPixmapItem. The image is split into
+ * fixed-size tiles at power-of-two levels (level 0 = full resolution, level n
+ * = 1/2^n). Only tiles intersecting the exposed rect are painted, at the level
+ * matching the current view scale. Downsampled levels and tile pixmaps are
+ * produced on worker threads; while a tile is missing, the nearest coarser
+ * cached tile is stretched in its place, or a finer level that is already
+ * built is scaled down when no coarser one exists yet.
+ *
+ * Pixels come from a shared ImageHandle and are not duplicated: a level that
+ * is already in a paint-ready 32-bit format is drawn straight from the handle's
+ * QImage, and only other formats go through converted tile pixmaps.
+ *
+ * The handle's image may be a downscaled preview of the source (one of the
+ * pyramid levels). Tiles finer than the preview are then read on demand via
+ * ImageHandle::readRegion(), or appear once refineImage() supplies the
+ * full-resolution pixels. A handle backed by a cached PyramidFile serves every
+ * level from the mapped file instead, so nothing is decoded or downsampled.
+ *
+ * Levels keep the native sample format (16-bit, float). A WindowLevel maps
+ * samples to screen values per tile on the workers; changing it only re-maps
+ * the visible tiles, while the previous tiles stay on screen until replaced.
+ *
+ * Item coordinates are source pixel coordinates, so scene positions of tie
+ * points are unaffected.
+ */
+class TiledImageItem : public QGraphicsObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int TileSize = 512;
+
+    explicit TiledImageItem(QGraphicsItem *parent = nullptr);
+    ~TiledImageItem() override;
+
+    // The handle's image is the source itself or one of its pyramid levels
+    void setImage(const ImageHandle &handle);
+    // Finer pixels of the same source (e.g. full resolution after a preview)
+    void refineImage(const ImageHandle &handle);
+
+    const ImageHandle &handle() const { return m_handle; }
+    QSize imageSize() const { return m_sourceSize; }
+    bool isNull() const { return m_handle.isNull(); }
+
+    // Upper bound for the GPU/pixmap tile cache (bytes)
+    void setTileCacheBudget(qint64 bytes);
+
+    // Display mapping (contrast); dataRange() is the sample min/max of the
+    // loaded pixels, in the same normalized units
+    void setWindowLevel(const WindowLevel &windowLevel);
+    WindowLevel windowLevel() const { return m_windowLevel; }
+    WindowLevel dataRange() const { return m_dataRange; }
+    bool isHighBitDepth() const;
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+               QWidget *widget = nullptr) override;
+
+private:
+    static quint64 tileKey(int level, int tx, int ty);
+
+    bool isLevelBuilt(int level) const;
+    int levelForScale(qreal scale) const;
+    int levelOfSize(const QSize &size) const;
+    QSize levelSize(int level) const;
+    QRectF tileSceneRect(int level, int tx, int ty) const;
+
+    bool drawFallback(QPainter *painter, int level, int tx, int ty);
+    void requestLevel(int level);
+    void requestTile(int level, int tx, int ty);
+    void requestRegionTile(int level, int tx, int ty);
+    void requestPyramidTile(int level, int tx, int ty);
+    void insertTile(quint64 key, quint64 tileGeneration, const QImage &tileImage, int level, int tx, int ty);
+    void invalidateTiles();
+
+    bool isPaintReady(const QImage &image) const;
+
+    struct Tile {
+        QPixmap pixmap;
+        quint64 generation;       // Tile generation the pixmap was mapped with
+    };
+
+    ImageHandle m_handle;
+    QSize m_sourceSize;
+    QVector<QImage> m_levels;     // Per level; null until built (index 0 = full resolution)
+    int m_baseLevel;
+    int m_maxLevel;               // Coarsest level (fits in a single tile)
+    bool m_levelPending;
+    bool m_regionDecodable;
+    QSharedPointer<const PyramidFile> m_pyramid;   // Null unless opened from the pyramid cache
+
+    WindowLevel m_windowLevel;
+    WindowLevel m_dataRange;
+    QSharedPointer<const WindowLevelLut> m_lut;   // Null: plain format conversion
+
+    QCache<quint64, Tile> m_tiles;     // Cost unit: KiB
+    QSet<quint64> m_pendingTiles;
+    quint64 m_generation;         // Bumped by setImage(); stale levels are dropped
+    // Bumped by setImage()/setWindowLevel(); shared with workers so queued
+    // tiles for an outdated mapping skip their work
+    QSharedPointer<QAtomicInteger<quint64>> m_tileGeneration;
+};
+
+#endif // TILEDIMAGEITEM_H
@@ -0,0 +1,313 @@
+#include "WarpOverlayItem.h"
+#include "TiledImageItem.h"
+
+#include <QFutureWatcher>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtMath>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RL_HAVE_SSE2
+#endif
+
+namespace {
+
+QSize halfSize(const QSize &size)
+{
+    return QSize(qMax(1, (size.width() + 1) / 2), qMax(1, (size.height() + 1) / 2));
+}
+
+// Native pixels -> 32-bit premultiplied-compatible, through the window/level if one is set
+QImage toDisplayFormat(const QImage &image, const QSharedPointer<const WindowLevelLut> &lut)
+{
+    if (lut)
+        return lut->apply(image);
+    const QImage::Format format = image.hasAlphaChannel()
+        ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+    return image.convertToFormat(format);
+}
+
+// Source pixels outside the image are transparent, so the edges fade out
+inline QRgb texel(const QRgb *bits, qsizetype stride, int width, int height, int x, int y)
+{
+    if (x < 0 || y < 0 || x >= width || y >= height)
+        return 0;
+    return bits[y * stride + x];
+}
+
+#ifdef RL_HAVE_SSE2
+inline __m128 unpackPixel(QRgb pixel)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i v = _mm_cvtsi32_si128(int(pixel));
+    v = _mm_unpacklo_epi8(v, zero);
+    v = _mm_unpacklo_epi16(v, zero);
+    return _mm_cvtepi32_ps(v);
+}
+
+inline QRgb packPixel(__m128 value)
+{
+    __m128i v = _mm_cvtps_epi32(value);
+    v = _mm_packs_epi32(v, v);
+    v = _mm_packus_epi16(v, v);
+    return QRgb(_mm_cvtsi128_si32(v));
+}
+#endif
+
+// Bilinear sample at (u, v), in pixel-center coordinates of source
+inline QRgb sampleBilinear(const QRgb *bits, qsizetype stride, int width, int height, double u, double v)
+{
+    const int x0 = int(std::floor(u));
+    const int y0 = int(std::floor(v));
+    if (x0 < -1 || y0 < -1 || x0 >= width || y0 >= height)
+        return 0;
+
+    const float fx = float(u - x0);
+    const float fy = float(v - y0);
+    QRgb p00, p10, p01, p11;
+    if (x0 >= 0 && y0 >= 0 && x0 + 1 < width && y0 + 1 < height) {
+        const QRgb *row = bits + y0 * stride + x0;
+        p00 = row[0];
+        p10 = row[1];
+        p01 = row[stride];
+        p11 = row[stride + 1];
+    } else {
+        p00 = texel(bits, stride, width, height, x0, y0);
+        p10 = texel(bits, stride, width, height, x0 + 1, y0);
+        p01 = texel(bits, stride, width, height, x0, y0 + 1);
+        p11 = texel(bits, stride, width, height, x0 + 1, y0 + 1);
+    }
+
+    const float w00 = (1.0f - fx) * (1.0f - fy);
+    const float w10 = fx * (1.0f - fy);
+    const float w01 = (1.0f - fx) * fy;
+    const float w11 = fx * fy;
+#ifdef RL_HAVE_SSE2
+    __m128 acc = _mm_mul_ps(_mm_set1_ps(w00), unpackPixel(p00));
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w10), unpackPixel(p10)));
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w01), unpackPixel(p01)));
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w11), unpackPixel(p11)));
+    return packPixel(acc);
+#else
+    auto channel = [&](int shift) {
+        const float value = w00 * ((p00 >> shift) & 0xff) + w10 * ((p10 >> shift) & 0xff)
+                          + w01 * ((p01 >> shift) & 0xff) + w11 * ((p11 >> shift) & 0xff);
+        return QRgb(qBound(0, int(value + 0.5f), 255)) << shift;
+    };
+    return channel(0) | channel(8) | channel(16) | channel(24);
+#endif
+}
+
+// Output rows [y0, y1): pixel (x, y) samples source at pixelToSource(x + 0.5, y + 0.5)
+void warpRows(const QImage &source, QImage &out, const QTransform &pixelToSource, int y0, int y1)
+{
+    const QRgb *bits = reinterpret_cast<const QRgb *>(source.constBits());
+    const qsizetype stride = source.bytesPerLine() / 4;
+    const int width = source.width();
+    const int height = source.height();
+    const double du = pixelToSource.m11();
+    const double dv = pixelToSource.m12();
+
+    for (int y = y0; y < y1; ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(out.scanLine(y));
+        // Affine: step along the row instead of mapping every pixel
+        const QPointF start = pixelToSource.map(QPointF(0.5, y + 0.5));
+        double u = start.x() - 0.5;
+        double v = start.y() - 0.5;
+        for (int x = 0; x < out.width(); ++x) {
+            line[x] = sampleBilinear(bits, stride, width, height, u, v);
+            u += du;
+            v += dv;
+        }
+    }
+}
+
+} // namespace
+
+WarpOverlayItem::WarpOverlayItem(QGraphicsItem *parent)
+    : QGraphicsObject(parent)
+    , m_highBitDepth(false)
+    , m_maxLevel(0)
+    , m_levelPending(false)
+    , m_generation(0)
+    , m_hasWarp(false)
+    , m_mode(Blend)
+{
+    // exposedRect limits the warp to what is visible
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+    setAcceptedMouseButtons(Qt::NoButton);
+}
+
+void WarpOverlayItem::setSource(const TiledImageItem *movingItem)
+{
+    const ImageHandle handle = movingItem ? movingItem->handle() : ImageHandle();
+    const WindowLevel windowLevel = movingItem ? movingItem->windowLevel() : WindowLevel();
+    const bool highBitDepth = movingItem && movingItem->isHighBitDepth();
+    if (handle == m_handle && windowLevel == m_windowLevel && highBitDepth == m_highBitDepth)
+        return;
+
+    prepareGeometryChange();
+    m_handle = handle;
+    m_windowLevel = windowLevel;
+    m_highBitDepth = highBitDepth;
+    m_lut.reset();
+    if (!m_windowLevel.isIdentity())
+        m_lut.reset(new WindowLevelLut(m_windowLevel, m_highBitDepth));
+
+    ++m_generation;
+    m_levelPending = false;
+    m_levels.clear();
+    m_maxLevel = 0;
+    if (!m_handle.isNull()) {
+        // Halve until the level fits in 512 px
+        QSize size = m_handle.image().size();
+        while (qMax(size.width(), size.height()) > 512) {
+            size = halfSize(size);
+            ++m_maxLevel;
+        }
+        m_levels.resize(m_maxLevel + 1);
+
+        // Paint-ready pixels are shared, not copied
+        const QImage &image = m_handle.image();
+        if (!m_lut && (image.format() == QImage::Format_RGB32
+                       || image.format() == QImage::Format_ARGB32_Premultiplied))
+            m_levels[0] = image;
+    }
+    update();
+}
+
+void WarpOverlayItem::setWarp(const QTransform &movingToFixed)
+{
+    bool invertible = false;
+    const QTransform fixedToMoving = movingToFixed.inverted(&invertible);
+    if (m_hasWarp && invertible && movingToFixed == m_movingToFixed)
+        return;
+
+    prepareGeometryChange();
+    m_hasWarp = invertible;
+    m_movingToFixed = movingToFixed;
+    m_fixedToMoving = fixedToMoving;
+    update();
+}
+
+void WarpOverlayItem::clearWarp()
+{
+    if (!m_hasWarp)
+        return;
+    prepareGeometryChange();
+    m_hasWarp = false;
+}
+
+void WarpOverlayItem::setMode(Mode mode)
+{
+    if (mode == m_mode)
+        return;
+    m_mode = mode;
+    update();
+}
+
+QRectF WarpOverlayItem::boundingRect() const
+{
+    if (!m_hasWarp || m_handle.isNull())
+        return QRectF();
+    return m_movingToFixed.mapRect(QRectF(QPointF(0, 0), QSizeF(m_handle.size())));
+}
+
+void WarpOverlayItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+    if (!m_hasWarp || m_handle.isNull())
+        return;
+
+    // Exposed area in device pixels
+    const QTransform itemToDevice = painter->worldTransform();
+    const QRect deviceBounds(0, 0, painter->device()->width(), painter->device()->height());
+    const QRect target = itemToDevice.mapRect(option->exposedRect.intersected(boundingRect()))
+                             .toAlignedRect().intersected(deviceBounds);
+    if (target.isEmpty())
+        return;
+
+    // Output pixel -> moving image pixel; the output is at device resolution
+    const qreal dpr = painter->device()->devicePixelRatioF();
+    const QTransform pixelToMoving = QTransform::fromScale(1.0 / dpr, 1.0 / dpr)
+        * QTransform::fromTranslate(target.x(), target.y())
+        * itemToDevice.inverted() * m_fixedToMoving;
+
+    // Level whose pixels are about the size of an output pixel
+    const qreal imageScale = qreal(m_handle.image().width()) / m_handle.width();
+    const qreal density = std::sqrt(qAbs(pixelToMoving.determinant())) * imageScale;
+    const int wanted = qBound(0, int(std::floor(std::log2(qMax<qreal>(density, 1.0)))), m_maxLevel);
+    if (!isLevelBuilt(wanted))
+        requestLevel(wanted);
+    int level = wanted;
+    while (level >= 0 && !isLevelBuilt(level))
+        --level;
+    if (level < 0)
+        return;     // Level 0 is being mapped
+
+    const QImage &source = m_levels.at(level);
+    const QTransform pixelToSource = pixelToMoving
+        * QTransform::fromScale(qreal(source.width()) / m_handle.width(),
+                                qreal(source.height()) / m_handle.height());
+
+    QImage out(qRound(target.width() * dpr), qRound(target.height() * dpr),
+               QImage::Format_ARGB32_Premultiplied);
+    QVector<int> bands;
+    for (int y = 0; y < out.height(); y += BandHeight)
+        bands.append(y);
+    QtConcurrent::blockingMap(bands, [&](int y0) {
+        warpRows(source, out, pixelToSource, y0, qMin(y0 + BandHeight, out.height()));
+    });
+    out.setDevicePixelRatio(dpr);
+
+    painter->save();
+    painter->resetTransform();
+    if (m_mode == Difference)
+        painter->setCompositionMode(QPainter::CompositionMode_Difference);
+    painter->drawImage(target.topLeft(), out);
+    painter->restore();
+}
+
+bool WarpOverlayItem::isLevelBuilt(int level) const
+{
+    return level >= 0 && level < m_levels.size() && !m_levels.at(level).isNull();
+}
+
+void WarpOverlayItem::requestLevel(int level)
+{
+    if (m_levelPending)
+        return;
+
+    // Levels are built one after another: the first missing one up to level
+    int next = 0;
+    while (next <= level && isLevelBuilt(next))
+        ++next;
+    if (next > level || next > m_maxLevel)
+        return;
+
+    m_levelPending = true;
+    const quint64 generation = m_generation;
+    const QImage previous = next > 0 ? m_levels.at(next - 1) : m_handle.image();
+    const QSharedPointer<const WindowLevelLut> lut = m_lut;
+
+    auto *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, generation, next]() {
+        watcher->deleteLater();
+        if (generation != m_generation)
+            return;
+        m_levelPending = false;
+        m_levels[next] = watcher->result();
+        update();
+    });
+
+    watcher->setFuture(QtConcurrent::run(QThreadPool::globalInstance(), [previous, lut, next]() -> QImage {
+        if (next == 0)
+            return toDisplayFormat(previous, lut);
+        return previous.scaled(halfSize(previous.size()), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }));
+}
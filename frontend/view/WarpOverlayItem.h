@@ -0,0 +1,83 @@
+#ifndef WARPOVERLAYITEM_H
+#define WARPOVERLAYITEM_H
+
+#include <QGraphicsObject>
+#include <QImage>
+#include <QSharedPointer>
+#include <QTransform>
+#include <QVector>
+#include "model/ImageHandle.h"
+#include "WindowLevel.h"
+
+class TiledImageItem;
+
+/**
+ * @brief Scene item in the fixed view that draws the moving image warped onto it.
+ *
+ * Shows the result of a computed transform in place, without the
+ * /warp/checkerboard round trip: the moving image is resampled locally,
+ * either blended over the fixed image (item opacity) or as the absolute
+ * difference of the two.
+ *
+ * Only the exposed part of the item is warped, at device resolution: every
+ * output pixel is mapped back into the moving image and sampled bilinearly
+ * (SSE2, the four channels of a pixel in one register), in row bands spread
+ * over the global thread pool. A new transform only costs the visible pixels
+ * and is on screen with the next frame.
+ *
+ * The moving pixels are mapped with the moving item's window/level and kept
+ * in a chain of halved levels built lazily on workers; zoomed out, a coarser
+ * level is sampled so the cost and aliasing stay bounded. Until a level is
+ * ready, the finest built one below it is used.
+ *
+ * Item coordinates are fixed image pixel coordinates.
+ */
+class WarpOverlayItem : public QGraphicsObject
+{
+    Q_OBJECT
+
+public:
+    enum Mode {
+        Blend,
+        Difference
+    };
+
+    explicit WarpOverlayItem(QGraphicsItem *parent = nullptr);
+
+    // Pixels and window/level of the moving image
+    void setSource(const TiledImageItem *movingItem);
+    // Maps moving image pixel coordinates to fixed image pixel coordinates
+    void setWarp(const QTransform &movingToFixed);
+    void clearWarp();
+    bool hasWarp() const { return m_hasWarp; }
+
+    void setMode(Mode mode);
+    Mode mode() const { return m_mode; }
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+               QWidget *widget = nullptr) override;
+
+private:
+    static constexpr int BandHeight = 32;
+
+    bool isLevelBuilt(int level) const;
+    void requestLevel(int level);
+
+    ImageHandle m_handle;
+    WindowLevel m_windowLevel;
+    bool m_highBitDepth;
+    QSharedPointer<const WindowLevelLut> m_lut;   // Null: plain format conversion
+
+    QVector<QImage> m_levels;     // Display-mapped, halved per level; null until built
+    int m_maxLevel;
+    bool m_levelPending;
+    quint64 m_generation;         // Bumped by setSource(); stale levels are dropped
+
+    bool m_hasWarp;
+    QTransform m_movingToFixed;
+    QTransform m_fixedToMoving;
+    Mode m_mode;
+};
+
+#endif // WARPOVERLAYITEM_H
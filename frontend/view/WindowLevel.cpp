@@ -0,0 +1,277 @@
+#include "WindowLevel.h"
+#include <QtMath>
+#include <algorithm>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RL_HAVE_SSE2
+#endif
+
+namespace {
+
+bool isFloatFormat(QImage::Format format)
+{
+    switch (format) {
+    case QImage::Format_RGBX16FPx4:
+    case QImage::Format_RGBA16FPx4:
+    case QImage::Format_RGBA16FPx4_Premultiplied:
+    case QImage::Format_RGBX32FPx4:
+    case QImage::Format_RGBA32FPx4:
+    case QImage::Format_RGBA32FPx4_Premultiplied:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Normalized sample -> 8-bit display value
+uchar mapSample(double value, const WindowLevel &wl)
+{
+    const double width = qMax(wl.high - wl.low, 1e-12);
+    double t = qBound(0.0, (value - wl.low) / width, 1.0);
+    if (wl.gamma != 1.0)
+        t = std::pow(t, 1.0 / wl.gamma);
+    return uchar(t * 255.0 + 0.5);
+}
+
+} // namespace
+
+// ============================================================================
+// WindowLevel
+// ============================================================================
+
+bool WindowLevel::isHighBitDepth(QImage::Format format)
+{
+    if (isFloatFormat(format))
+        return true;
+
+    switch (format) {
+    case QImage::Format_Grayscale16:
+    case QImage::Format_RGBX64:
+    case QImage::Format_RGBA64:
+    case QImage::Format_RGBA64_Premultiplied:
+    case QImage::Format_BGR30:
+    case QImage::Format_A2BGR30_Premultiplied:
+    case QImage::Format_RGB30:
+    case QImage::Format_A2RGB30_Premultiplied:
+        return true;
+    default:
+        return false;
+    }
+}
+
+WindowLevel WindowLevel::fromPercentiles(const QImage &image, double lowFraction, double highFraction)
+{
+    WindowLevel wl;
+    if (image.isNull())
+        return wl;
+
+    // Nearest-neighbour subsample keeps sample values exact
+    QImage sample = image;
+    if (image.width() > 512 || image.height() > 512)
+        sample = image.scaled(512, 512, Qt::KeepAspectRatio, Qt::FastTransformation);
+
+    std::vector<float> values;
+    values.reserve(size_t(sample.width()) * sample.height() * 3);
+
+    if (isFloatFormat(sample.format())) {
+        sample = sample.convertToFormat(QImage::Format_RGBA32FPx4);
+        for (int y = 0; y < sample.height(); ++y) {
+            const float *line = reinterpret_cast<const float *>(sample.constScanLine(y));
+            for (int x = 0; x < sample.width(); ++x) {
+                for (int c = 0; c < 3; ++c) {
+                    const float v = line[4 * x + c];
+                    if (std::isfinite(v))
+                        values.push_back(v);
+                }
+            }
+        }
+    } else if (isHighBitDepth(sample.format())) {
+        sample = sample.convertToFormat(QImage::Format_RGBA64);
+        for (int y = 0; y < sample.height(); ++y) {
+            const QRgba64 *line = reinterpret_cast<const QRgba64 *>(sample.constScanLine(y));
+            for (int x = 0; x < sample.width(); ++x) {
+                values.push_back(line[x].red() / 65535.0f);
+                values.push_back(line[x].green() / 65535.0f);
+                values.push_back(line[x].blue() / 65535.0f);
+            }
+        }
+    } else {
+        sample = sample.convertToFormat(QImage::Format_ARGB32);
+        for (int y = 0; y < sample.height(); ++y) {
+            const QRgb *line = reinterpret_cast<const QRgb *>(sample.constScanLine(y));
+            for (int x = 0; x < sample.width(); ++x) {
+                values.push_back(qRed(line[x]) / 255.0f);
+                values.push_back(qGreen(line[x]) / 255.0f);
+                values.push_back(qBlue(line[x]) / 255.0f);
+            }
+        }
+    }
+
+    if (values.empty())
+        return wl;
+
+    auto percentile = [&values](double fraction) -> float {
+        const size_t index = size_t(qBound(0.0, fraction, 1.0) * (values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    };
+
+    wl.low = percentile(lowFraction);
+    wl.high = percentile(highFraction);
+    if (wl.high <= wl.low)
+        wl.high = wl.low + 1e-6;
+    return wl;
+}
+
+// ============================================================================
+// WindowLevelLut
+// ============================================================================
+
+WindowLevelLut::WindowLevelLut(const WindowLevel &windowLevel, bool needs16Bit)
+    : m_windowLevel(windowLevel)
+{
+    m_lut8.resize(256);
+    for (int i = 0; i < 256; ++i)
+        m_lut8[i] = mapSample(i / 255.0, m_windowLevel);
+
+    if (needs16Bit) {
+        m_lut16.resize(65536);
+        for (int i = 0; i < 65536; ++i)
+            m_lut16[i] = mapSample(i / 65535.0, m_windowLevel);
+    }
+
+    // Window is applied arithmetically for floats; this only covers gamma
+    WindowLevel gammaOnly;
+    gammaOnly.gamma = m_windowLevel.gamma;
+    m_gammaTable.resize(GammaTableSize);
+    for (int i = 0; i < GammaTableSize; ++i)
+        m_gammaTable[i] = mapSample(double(i) / (GammaTableSize - 1), gammaOnly);
+}
+
+QImage WindowLevelLut::apply(const QImage &source) const
+{
+    if (source.isNull())
+        return QImage();
+
+    if (isFloatFormat(source.format()))
+        return applyFloat(source);
+    if (WindowLevel::isHighBitDepth(source.format()) && !m_lut16.isEmpty())
+        return applyInteger16(source);
+    return applyInteger8(source);
+}
+
+QImage WindowLevelLut::applyInteger8(const QImage &source) const
+{
+    const uchar *lut = m_lut8.constData();
+    const int w = source.width();
+    const int h = source.height();
+
+    if (source.format() == QImage::Format_Grayscale8) {
+        QImage out(w, h, QImage::Format_RGB32);
+        for (int y = 0; y < h; ++y) {
+            const uchar *src = source.constScanLine(y);
+            QRgb *dst = reinterpret_cast<QRgb *>(out.scanLine(y));
+            for (int x = 0; x < w; ++x) {
+                const uint v = lut[src[x]];
+                dst[x] = 0xff000000u | (v << 16) | (v << 8) | v;
+            }
+        }
+        return out;
+    }
+
+    const bool hasAlpha = source.hasAlphaChannel();
+    const QImage argb = source.convertToFormat(hasAlpha ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+    QImage out(w, h, hasAlpha ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+    for (int y = 0; y < h; ++y) {
+        const QRgb *src = reinterpret_cast<const QRgb *>(argb.constScanLine(y));
+        QRgb *dst = reinterpret_cast<QRgb *>(out.scanLine(y));
+        for (int x = 0; x < w; ++x) {
+            const QRgb p = src[x];
+            dst[x] = qRgba(lut[qRed(p)], lut[qGreen(p)], lut[qBlue(p)], qAlpha(p));
+        }
+    }
+    return hasAlpha ? out.convertToFormat(QImage::Format_ARGB32_Premultiplied) : out;
+}
+
+QImage WindowLevelLut::applyInteger16(const QImage &source) const
+{
+    const uchar *lut = m_lut16.constData();
+    const int w = source.width();
+    const int h = source.height();
+
+    if (source.format() == QImage::Format_Grayscale16) {
+        QImage out(w, h, QImage::Format_RGB32);
+        for (int y = 0; y < h; ++y) {
+            const quint16 *src = reinterpret_cast<const quint16 *>(source.constScanLine(y));
+            QRgb *dst = reinterpret_cast<QRgb *>(out.scanLine(y));
+            for (int x = 0; x < w; ++x) {
+                const uint v = lut[src[x]];
+                dst[x] = 0xff000000u | (v << 16) | (v << 8) | v;
+            }
+        }
+        return out;
+    }
+
+    const bool hasAlpha = source.hasAlphaChannel();
+    const QImage rgba = source.convertToFormat(QImage::Format_RGBA64);
+    QImage out(w, h, hasAlpha ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+    for (int y = 0; y < h; ++y) {
+        const QRgba64 *src = reinterpret_cast<const QRgba64 *>(rgba.constScanLine(y));
+        QRgb *dst = reinterpret_cast<QRgb *>(out.scanLine(y));
+        for (int x = 0; x < w; ++x) {
+            const QRgba64 p = src[x];
+            dst[x] = qRgba(lut[p.red()], lut[p.green()], lut[p.blue()], p.alpha8());
+        }
+    }
+    return hasAlpha ? out.convertToFormat(QImage::Format_ARGB32_Premultiplied) : out;
+}
+
+QImage WindowLevelLut::applyFloat(const QImage &source) const
+{
+    const bool hasAlpha = source.hasAlphaChannel();
+    const QImage rgba = source.convertToFormat(QImage::Format_RGBA32FPx4);
+    const int w = rgba.width();
+    const int h = rgba.height();
+    const uchar *table = m_gammaTable.constData();
+
+    const float low = float(m_windowLevel.low);
+    const float scale = float(1.0 / qMax(m_windowLevel.high - m_windowLevel.low, 1e-12));
+    const float tableMax = float(GammaTableSize - 1);
+
+    QImage out(w, h, hasAlpha ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+
+#ifdef RL_HAVE_SSE2
+    const __m128 lowV = _mm_set1_ps(low);
+    const __m128 scaleV = _mm_set1_ps(scale);
+    const __m128 zeroV = _mm_setzero_ps();
+    const __m128 oneV = _mm_set1_ps(1.0f);
+    const __m128 tableMaxV = _mm_set1_ps(tableMax);
+#endif
+
+    for (int y = 0; y < h; ++y) {
+        const float *src = reinterpret_cast<const float *>(rgba.constScanLine(y));
+        QRgb *dst = reinterpret_cast<QRgb *>(out.scanLine(y));
+        for (int x = 0; x < w; ++x) {
+            const float *p = src + 4 * x;
+            int idx[4];
+#ifdef RL_HAVE_SSE2
+            // One pixel (R, G, B, A lanes) per iteration; NaN clamps to 0
+            __m128 v = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(p), lowV), scaleV);
+            v = _mm_min_ps(_mm_max_ps(v, zeroV), oneV);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(idx), _mm_cvtps_epi32(_mm_mul_ps(v, tableMaxV)));
+#else
+            for (int c = 0; c < 3; ++c) {
+                const float t = (p[c] - low) * scale;
+                idx[c] = int(qBound(0.0f, t == t ? t : 0.0f, 1.0f) * tableMax + 0.5f);
+            }
+#endif
+            // Alpha is never windowed
+            const int alpha = int(qBound(0.0f, p[3], 1.0f) * 255.0f + 0.5f);
+            dst[x] = qRgba(table[idx[0]], table[idx[1]], table[idx[2]], alpha);
+        }
+    }
+
+    return hasAlpha ? out.convertToFormat(QImage::Format_ARGB32_Premultiplied) : out;
+}
@@ -0,0 +1,67 @@
+#ifndef WINDOWLEVEL_H
+#define WINDOWLEVEL_H
+
+#include <QImage>
+#include <QVector>
+
+/**
+ * @brief Display mapping from native samples to 8-bit screen values.
+ *
+ * Sample values are normalized: integer formats map their full code range to
+ * [0, 1] (so 65535 in a 16-bit image is 1.0), float formats use the stored
+ * value as is. Samples at or below low become black, at or above high white,
+ * with gamma applied in between.
+ */
+struct WindowLevel
+{
+    double low = 0.0;
+    double high = 1.0;
+    double gamma = 1.0;
+
+    bool isIdentity() const { return low == 0.0 && high == 1.0 && gamma == 1.0; }
+    bool operator==(const WindowLevel &other) const
+    {
+        return low == other.low && high == other.high && gamma == other.gamma;
+    }
+    bool operator!=(const WindowLevel &other) const { return !(*this == other); }
+
+    // Window spanning the given percentiles of the image's samples
+    // (0.0/1.0 gives the min/max). Subsamples large images.
+    static WindowLevel fromPercentiles(const QImage &image, double lowFraction, double highFraction);
+
+    // More than 8 bits per channel (16-bit integer or floating point)
+    static bool isHighBitDepth(QImage::Format format);
+};
+
+/**
+ * @brief Precomputed lookup tables for one WindowLevel.
+ *
+ * Built once on the GUI thread whenever the window changes and shared
+ * read-only with tile workers. Integer samples (8/16-bit) go through a
+ * direct lookup table; float samples are windowed with SSE2 arithmetic and a
+ * small gamma table.
+ */
+class WindowLevelLut
+{
+public:
+    explicit WindowLevelLut(const WindowLevel &windowLevel, bool needs16Bit);
+
+    const WindowLevel &windowLevel() const { return m_windowLevel; }
+
+    // Maps a region of native pixels to Format_RGB32 / ARGB32_Premultiplied
+    QImage apply(const QImage &source) const;
+
+private:
+    static constexpr int GammaTableSize = 4096;
+
+    QImage applyInteger8(const QImage &source) const;
+    QImage applyInteger16(const QImage &source) const;
+    QImage applyFloat(const QImage &source) const;
+
+    WindowLevel m_windowLevel;
+    QVector<uchar> m_lut8;        // 256 entries
+    QVector<uchar> m_lut16;       // 65536 entries (only for 16-bit sources)
+    QVector<uchar> m_gammaTable;  // [0, 1] -> 8-bit, GammaTableSize entries
+};
+
+#endif // WINDOWLEVEL_H